@@ -0,0 +1,235 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "uniform_batch.h"
+
+#include <boost/math/distributions/binomial.hpp>
+#include <boost/math/distributions/negative_binomial.hpp>
+#include <boost/math/distributions/poisson.hpp>
+#include <boost/math/distributions/geometric.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <array>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <exception>
+#include <functional>
+
+
+// Walker, Vose, alias method:
+// one 64 bit word per value, the upper half selects the column,
+// the lower half decides between column and alias
+class AliasTable
+{
+public:
+
+	// probabilities of the values offset, offset + 1, ...
+	AliasTable(const std::vector<double>& probabilities, const std::int64_t offset) :
+		offset(offset),
+		thresholds(probabilities.size()),
+		aliases(probabilities.size())
+	{
+		const size_t size = probabilities.size();
+		const double total = std::accumulate(probabilities.cbegin(), probabilities.cend(), 0.0);
+
+		std::vector<double> scaled(size);
+		std::vector<size_t> small;
+		std::vector<size_t> large;
+
+		for (size_t index = 0; index < size; ++index)
+		{
+			scaled[index] = probabilities[index] * static_cast<double>(size) / total;
+			scaled[index] < 1.0 ? small.push_back(index) : large.push_back(index);
+		}
+
+		while (!small.empty() && !large.empty())
+		{
+			const size_t small_index = small.back();
+			small.pop_back();
+			const size_t large_index = large.back();
+			large.pop_back();
+
+			SetColumn(small_index, scaled[small_index], large_index);
+
+			scaled[large_index] = (scaled[large_index] + scaled[small_index]) - 1.0;
+			scaled[large_index] < 1.0 ? small.push_back(large_index) : large.push_back(large_index);
+		}
+
+		// remaining columns are full up to rounding errors
+		for (const size_t index : large)
+		{
+			SetColumn(index, 1.0, index);
+		}
+		for (const size_t index : small)
+		{
+			SetColumn(index, 1.0, index);
+		}
+	}
+
+	size_t GetSize() const
+	{
+		return thresholds.size();
+	}
+
+	template<typename EngineTy>
+	std::int64_t Sample(EngineTy& engine) const
+	{
+		std::uint64_t bits;
+		FillRandomBits(engine, &bits, 1);
+		return SampleFromBits(bits);
+	}
+
+	template<typename EngineTy, typename IntegerTy>
+	void Fill(EngineTy& engine, IntegerTy* values, const size_t count) const
+	{
+		alignas(64) std::array<std::uint64_t, uniform_batch_size> bits;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+
+			FillRandomBits(engine, bits.data(), batch_count);
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				values[offset + index] = static_cast<IntegerTy>(SampleFromBits(bits[index]));
+			}
+		}
+	}
+
+private:
+
+	void SetColumn(const size_t index, const double probability, const size_t alias)
+	{
+		const double scale = 4294967296.0;
+		thresholds[index] = probability >= 1.0 ? static_cast<std::uint64_t>(scale) : static_cast<std::uint64_t>(probability * scale);
+		aliases[index] = static_cast<std::uint32_t>(alias);
+	}
+
+	std::int64_t SampleFromBits(const std::uint64_t bits) const
+	{
+		const std::uint64_t column = ((bits >> 32) * thresholds.size()) >> 32;
+		const std::uint64_t coin = bits & 0xFFFFFFFFull;
+		const std::uint64_t selected = coin < thresholds[column] ? column : aliases[column];
+		return offset + static_cast<std::int64_t>(selected);
+	}
+
+	std::int64_t offset;
+	std::vector<std::uint64_t> thresholds;
+	std::vector<std::uint32_t> aliases;
+};
+
+
+// Tables of discrete boost::math distributions,
+// the support is truncated to the quantiles epsilon / 2 and 1 - epsilon / 2
+template<typename DistributionTy>
+std::shared_ptr<const AliasTable> CreateAliasTable(const DistributionTy& distribution, const double epsilon, const size_t max_size)
+{
+	const double lower = std::floor(boost::math::quantile(distribution, epsilon / 2));
+	const double upper = std::ceil(boost::math::quantile(boost::math::complement(distribution, epsilon / 2)));
+
+	if (!(upper - lower < static_cast<double>(max_size)))
+	{
+		return nullptr;
+	}
+
+	const size_t size = static_cast<size_t>(upper - lower) + 1;
+	std::vector<double> probabilities(size);
+
+	for (size_t index = 0; index < size; ++index)
+	{
+		probabilities[index] = boost::math::pdf(distribution, lower + static_cast<double>(index));
+	}
+
+	return std::make_shared<const AliasTable>(probabilities, static_cast<std::int64_t>(lower));
+}
+
+
+// Tables of one SamplingManager, keyed by distribution parameters,
+// regenerating with unchanged parameters reuses the table
+class AliasTableCache
+{
+public:
+
+	static constexpr double default_epsilon = 1e-12;
+
+	AliasTableCache() :
+		epsilon(default_epsilon),
+		max_table_size(size_t(1) << 22),
+		max_number_tables(16)
+	{}
+
+	void SetEpsilon(const double epsilon)
+	{
+		this->epsilon = epsilon;
+	}
+
+	double GetEpsilon() const
+	{
+		return epsilon;
+	}
+
+	// nullptr if the parameters are invalid
+	// or the table would exceed max_size
+	std::shared_ptr<const AliasTable> GetTable(const std::array<double, 2>& parameters, const std::function<std::shared_ptr<const AliasTable>(double, size_t)>& create_table, size_t max_size = 0)
+	{
+		max_size = max_size == 0 ? max_table_size : std::min(max_size, max_table_size);
+
+		const std::array<double, 4> key = { parameters[0], parameters[1], epsilon, static_cast<double>(max_size) };
+
+		const auto found = tables.find(key);
+		if (found != tables.cend())
+		{
+			return found->second;
+		}
+
+		std::shared_ptr<const AliasTable> table;
+		try
+		{
+			table = create_table(epsilon, max_size);
+		}
+		catch (const std::exception&)
+		{
+			table = nullptr;
+		}
+
+		if (tables.size() >= max_number_tables)
+		{
+			tables.clear();
+		}
+		tables[key] = table;
+
+		return table;
+	}
+
+private:
+	double epsilon;
+	const size_t max_table_size;
+	const size_t max_number_tables;
+	std::map<std::array<double, 4>, std::shared_ptr<const AliasTable>> tables;
+};
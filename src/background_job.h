@@ -0,0 +1,237 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <exception>
+
+
+// cancellation flag and progress of one job,
+// the job polls IsCancelled between steps
+class JobControl
+{
+public:
+
+	JobControl() :
+		cancelled(false),
+		completed_steps(0),
+		total_steps(0)
+	{}
+
+	void Cancel()
+	{
+		cancelled.store(true, std::memory_order_relaxed);
+	}
+
+	bool IsCancelled() const
+	{
+		return cancelled.load(std::memory_order_relaxed);
+	}
+
+	void AddSteps(const size_t number_steps)
+	{
+		total_steps.fetch_add(number_steps, std::memory_order_relaxed);
+	}
+
+	void CompleteStep()
+	{
+		completed_steps.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// in [0, 1]
+	float GetProgress() const
+	{
+		const size_t total = total_steps.load(std::memory_order_relaxed);
+		const size_t completed = completed_steps.load(std::memory_order_relaxed);
+		return total == 0 ? 0.f : static_cast<float>(completed) / static_cast<float>(total);
+	}
+
+private:
+	std::atomic<bool> cancelled;
+	std::atomic<size_t> completed_steps;
+	std::atomic<size_t> total_steps;
+};
+
+
+// Runs jobs on its own thread, which is started by the first Submit.
+// Only the latest job matters: Submit cancels the running job
+// and replaces a submitted job that has not started yet.
+// The exception of the latest job is kept until the next Submit,
+// GetException returns it and Wait rethrows it.
+class LatestJobRunner
+{
+public:
+
+	using JobTy = std::function<void(JobControl&)>;
+
+	LatestJobRunner() :
+		job_pending(false),
+		job_running(false),
+		stop(false)
+	{}
+
+	~LatestJobRunner()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			if (running_control)
+			{
+				running_control->Cancel();
+			}
+		}
+		job_available.notify_all();
+
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	LatestJobRunner(const LatestJobRunner&) = delete;
+	LatestJobRunner& operator=(const LatestJobRunner&) = delete;
+
+	void Submit(JobTy job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (!worker.joinable())
+			{
+				worker = std::thread(&LatestJobRunner::Work, this);
+			}
+
+			if (running_control)
+			{
+				running_control->Cancel();
+			}
+
+			pending_job = std::move(job);
+			job_pending = true;
+			job_exception = nullptr;
+		}
+		job_available.notify_all();
+	}
+
+	// blocks until no job is pending or running
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [this]()
+			{
+				return !job_pending && !job_running;
+			});
+
+		if (job_exception)
+		{
+			std::rethrow_exception(job_exception);
+		}
+	}
+
+	// nullptr while the latest job is pending, running or succeeded
+	std::exception_ptr GetException() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return job_exception;
+	}
+
+	bool IsBusy() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return job_pending || job_running;
+	}
+
+	// progress of the running job, 0 while a job waits to start
+	float GetProgress() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return running_control && !job_pending ? running_control->GetProgress() : 0.f;
+	}
+
+private:
+
+	void Work()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true)
+		{
+			job_available.wait(lock, [this]()
+				{
+					return stop || job_pending;
+				});
+
+			if (stop)
+			{
+				return;
+			}
+
+			JobTy job = std::move(pending_job);
+			job_pending = false;
+			job_running = true;
+			running_control = std::make_shared<JobControl>();
+			const std::shared_ptr<JobControl> control = running_control;
+
+			lock.unlock();
+
+			std::exception_ptr exception;
+			try
+			{
+				job(*control);
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+
+			lock.lock();
+
+			job_running = false;
+			running_control.reset();
+			// a job replaced while it ran is not the latest one
+			if (exception && !job_pending)
+			{
+				job_exception = exception;
+			}
+
+			idle.notify_all();
+		}
+	}
+
+	JobTy pending_job;
+	bool job_pending;
+	bool job_running;
+	bool stop;
+	std::shared_ptr<JobControl> running_control;
+	std::exception_ptr job_exception;
+
+	mutable std::mutex mutex;
+	std::condition_variable job_available;
+	std::condition_variable idle;
+	std::thread worker;
+};
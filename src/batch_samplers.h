@@ -0,0 +1,782 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "uniform_batch.h"
+#include "ziggurat.h"
+#include "simd_math.h"
+#include "alias_table.h"
+#include "discrete_samplers.h"
+#include "gamma_samplers.h"
+#include "inverse_cdf_table.h"
+
+#include <random>
+#include <cmath>
+#include <array>
+#include <optional>
+#include <variant>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+
+// Fill writes count values of the distribution at once,
+// the primary template draws them one by one from the std distribution,
+// specializations transform a batch of uniform numbers
+// or look up precomputed tables,
+// CreateBatchSampler attaches the tables of a SamplingManager
+
+template<typename DistributionTy>
+class BatchSampler
+{
+public:
+
+	using ResultTy = typename DistributionTy::result_type;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{
+		distribution.reset();
+	}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		return distribution(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = distribution(engine);
+		}
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::uniform_real_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::uniform_real_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		ResultTy value;
+		Fill(engine, &value, 1);
+		return value;
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		FillUniform(engine, values, count);
+
+		const RealTy a = distribution.a();
+		const RealTy range = distribution.b() - distribution.a();
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = a + range * values[index];
+		}
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::exponential_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::exponential_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		ResultTy value;
+		Fill(engine, &value, 1);
+		return value;
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		FillUniform(engine, values, count, open_open);
+
+		const RealTy inverse_lambda = static_cast<RealTy>(1) / distribution.lambda();
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = -std::log(values[index]) * inverse_lambda;
+		}
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::weibull_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::weibull_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		ResultTy value;
+		Fill(engine, &value, 1);
+		return value;
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		FillUniform(engine, values, count, open_open);
+
+		const RealTy inverse_a = static_cast<RealTy>(1) / distribution.a();
+		const RealTy b = distribution.b();
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = b * std::pow(-std::log(values[index]), inverse_a);
+		}
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::extreme_value_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::extreme_value_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		ResultTy value;
+		Fill(engine, &value, 1);
+		return value;
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		FillUniform(engine, values, count, open_open);
+
+		const RealTy a = distribution.a();
+		const RealTy b = distribution.b();
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = a - b * std::log(-std::log(values[index]));
+		}
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::cauchy_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::cauchy_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		ResultTy value;
+		Fill(engine, &value, 1);
+		return value;
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		FillUniform(engine, values, count, open_open);
+
+		const RealTy a = distribution.a();
+		const RealTy b = distribution.b();
+		const RealTy pi = static_cast<RealTy>(3.14159265358979323846);
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = a + b * std::tan(pi * (values[index] - static_cast<RealTy>(0.5)));
+		}
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::normal_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::normal_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		return distribution.mean() + distribution.stddev() * ziggurat.Sample(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		ziggurat.Fill(engine, values, count);
+
+		const RealTy mean = distribution.mean();
+		const RealTy stddev = distribution.stddev();
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = mean + stddev * values[index];
+		}
+	}
+
+private:
+	DistributionTy distribution;
+	ZigguratNormal<RealTy> ziggurat;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::lognormal_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::lognormal_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		return std::exp(distribution.m() + distribution.s() * ziggurat.Sample(engine));
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		ziggurat.Fill(engine, values, count);
+
+		const RealTy m = distribution.m();
+		const RealTy s = distribution.s();
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = m + s * values[index];
+		}
+
+		ExpBatch(values, count);
+	}
+
+private:
+	DistributionTy distribution;
+	ZigguratNormal<RealTy> ziggurat;
+};
+
+
+// gamma, chi squared, student t and fisher f share the Marsaglia Tsang kernel,
+// the parameters are read once here, the std distributions are not used for sampling
+
+template<typename RealTy>
+class BatchSampler<std::gamma_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::gamma_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		beta(distribution.beta()),
+		gamma(distribution.alpha())
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		return beta * gamma.Sample(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		gamma.Fill(engine, values, count);
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] *= beta;
+		}
+	}
+
+private:
+	RealTy beta;
+	MarsagliaTsangGamma<RealTy> gamma;
+};
+
+
+template<typename RealTy>
+class BatchSampler<std::chi_squared_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::chi_squared_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		gamma(distribution.n() / static_cast<RealTy>(2))
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		return static_cast<RealTy>(2) * gamma.Sample(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		gamma.Fill(engine, values, count);
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] *= static_cast<RealTy>(2);
+		}
+	}
+
+private:
+	MarsagliaTsangGamma<RealTy> gamma;
+};
+
+
+// normal / sqrt(chi squared(n) / n) = normal * sqrt(n / (2 * gamma(n / 2)))
+template<typename RealTy>
+class BatchSampler<std::student_t_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::student_t_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		half_n(distribution.n() / static_cast<RealTy>(2)),
+		gamma(distribution.n() / static_cast<RealTy>(2))
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		const RealTy normal = ziggurat.Sample(engine);
+		return normal * std::sqrt(half_n / gamma.Sample(engine));
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		alignas(64) std::array<RealTy, uniform_batch_size> denominator;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+			RealTy* batch_values = values + offset;
+
+			ziggurat.Fill(engine, batch_values, batch_count);
+			gamma.Fill(engine, denominator.data(), batch_count);
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				batch_values[index] *= std::sqrt(half_n / denominator[index]);
+			}
+		}
+	}
+
+private:
+	RealTy half_n;
+	ZigguratNormal<RealTy> ziggurat;
+	MarsagliaTsangGamma<RealTy> gamma;
+};
+
+
+// (chi squared(m) / m) / (chi squared(n) / n) = (n * gamma(m / 2)) / (m * gamma(n / 2))
+template<typename RealTy>
+class BatchSampler<std::fisher_f_distribution<RealTy>>
+{
+public:
+
+	using DistributionTy = std::fisher_f_distribution<RealTy>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		ratio(distribution.n() / distribution.m()),
+		numerator_gamma(distribution.m() / static_cast<RealTy>(2)),
+		denominator_gamma(distribution.n() / static_cast<RealTy>(2))
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		const RealTy numerator = numerator_gamma.Sample(engine);
+		return ratio * numerator / denominator_gamma.Sample(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		alignas(64) std::array<RealTy, uniform_batch_size> denominator;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+			RealTy* batch_values = values + offset;
+
+			numerator_gamma.Fill(engine, batch_values, batch_count);
+			denominator_gamma.Fill(engine, denominator.data(), batch_count);
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				batch_values[index] = ratio * batch_values[index] / denominator[index];
+			}
+		}
+	}
+
+private:
+	RealTy ratio;
+	MarsagliaTsangGamma<RealTy> numerator_gamma;
+	MarsagliaTsangGamma<RealTy> denominator_gamma;
+};
+
+
+// boost::math distributions by lookup in their inverse cdf table,
+// the copy of the distribution shares its table
+template<typename BoostDistributionTy, typename RealTy, size_t NumberParameters>
+class BatchSampler<TabulatedDistribution<BoostDistributionTy, RealTy, NumberParameters>>
+{
+public:
+
+	using DistributionTy = TabulatedDistribution<BoostDistributionTy, RealTy, NumberParameters>;
+	using ResultTy = RealTy;
+
+	BatchSampler(const DistributionTy& distribution) :
+		distribution(distribution)
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		return distribution(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		distribution.Fill(engine, values, count);
+	}
+
+private:
+	DistributionTy distribution;
+};
+
+// discrete distributions with fixed parameters:
+// alias table for supports of cache friendly size,
+// LargeSamplerTy beyond, the std distribution otherwise
+template<typename DistributionTy, typename LargeSamplerTy = void>
+class DiscreteBatchSampler
+{
+public:
+
+	using ResultTy = typename DistributionTy::result_type;
+	using LargeTy = typename std::conditional<std::is_void<LargeSamplerTy>::value, std::monostate, LargeSamplerTy>::type;
+
+	DiscreteBatchSampler(const DistributionTy& distribution, std::shared_ptr<const AliasTable> table = nullptr, std::optional<LargeTy> large_sampler = std::nullopt) :
+		distribution(distribution),
+		table(table),
+		large_sampler(large_sampler)
+	{}
+
+	void Reset()
+	{
+		distribution.reset();
+
+		if constexpr (!std::is_void<LargeSamplerTy>::value)
+		{
+			if (large_sampler.has_value())
+			{
+				large_sampler->Reset();
+			}
+		}
+	}
+
+	template<typename EngineTy>
+	ResultTy Sample(EngineTy& engine)
+	{
+		if (table)
+		{
+			return static_cast<ResultTy>(table->Sample(engine));
+		}
+
+		if constexpr (!std::is_void<LargeSamplerTy>::value)
+		{
+			if (large_sampler.has_value())
+			{
+				return static_cast<ResultTy>(large_sampler->Sample(engine));
+			}
+		}
+
+		return distribution(engine);
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, ResultTy* values, const size_t count)
+	{
+		if (table)
+		{
+			table->Fill(engine, values, count);
+			return;
+		}
+
+		if constexpr (!std::is_void<LargeSamplerTy>::value)
+		{
+			if (large_sampler.has_value())
+			{
+				large_sampler->Fill(engine, values, count);
+				return;
+			}
+		}
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = distribution(engine);
+		}
+	}
+
+private:
+	DistributionTy distribution;
+	std::shared_ptr<const AliasTable> table;
+	std::optional<LargeTy> large_sampler;
+};
+
+template<typename IntegerTy>
+class BatchSampler<std::binomial_distribution<IntegerTy>> : public DiscreteBatchSampler<std::binomial_distribution<IntegerTy>, BtpeBinomial>
+{
+public:
+	using DiscreteBatchSampler<std::binomial_distribution<IntegerTy>, BtpeBinomial>::DiscreteBatchSampler;
+};
+
+template<typename IntegerTy>
+class BatchSampler<std::negative_binomial_distribution<IntegerTy>> : public DiscreteBatchSampler<std::negative_binomial_distribution<IntegerTy>>
+{
+public:
+	using DiscreteBatchSampler<std::negative_binomial_distribution<IntegerTy>>::DiscreteBatchSampler;
+};
+
+template<typename IntegerTy>
+class BatchSampler<std::poisson_distribution<IntegerTy>> : public DiscreteBatchSampler<std::poisson_distribution<IntegerTy>, PtrsPoisson>
+{
+public:
+	using DiscreteBatchSampler<std::poisson_distribution<IntegerTy>, PtrsPoisson>::DiscreteBatchSampler;
+};
+
+template<typename IntegerTy>
+class BatchSampler<std::geometric_distribution<IntegerTy>> : public DiscreteBatchSampler<std::geometric_distribution<IntegerTy>, InversionGeometric>
+{
+public:
+	using DiscreteBatchSampler<std::geometric_distribution<IntegerTy>, InversionGeometric>::DiscreteBatchSampler;
+};
+
+
+// alias tables above this size miss the cache on most draws,
+// binomial, poisson and geometric switch to BTPE, PTRS and inversion
+constexpr size_t alias_table_cache_friendly_size = size_t(1) << 14;
+
+template<typename DistributionTy>
+BatchSampler<DistributionTy> CreateBatchSampler(const DistributionTy& distribution, AliasTableCache&)
+{
+	return BatchSampler<DistributionTy>(distribution);
+}
+
+template<typename IntegerTy>
+BatchSampler<std::binomial_distribution<IntegerTy>> CreateBatchSampler(const std::binomial_distribution<IntegerTy>& distribution, AliasTableCache& alias_table_cache)
+{
+	const double t = static_cast<double>(distribution.t());
+	const double p = distribution.p();
+
+	auto table = alias_table_cache.GetTable({ t, p }, [t, p](const double epsilon, const size_t max_size)
+		{
+			return CreateAliasTable(boost::math::binomial_distribution<double>(t, p), epsilon, max_size);
+		}, alias_table_cache_friendly_size);
+
+	std::optional<BtpeBinomial> btpe;
+	if (!table && p > 0.0 && p < 1.0 && t * std::min(p, 1.0 - p) >= BtpeBinomial::min_mean)
+	{
+		btpe.emplace(static_cast<std::int64_t>(t), p);
+	}
+
+	return BatchSampler<std::binomial_distribution<IntegerTy>>(distribution, table, btpe);
+}
+
+template<typename IntegerTy>
+BatchSampler<std::negative_binomial_distribution<IntegerTy>> CreateBatchSampler(const std::negative_binomial_distribution<IntegerTy>& distribution, AliasTableCache& alias_table_cache)
+{
+	const double k = static_cast<double>(distribution.k());
+	const double p = distribution.p();
+
+	auto table = alias_table_cache.GetTable({ k, p }, [k, p](const double epsilon, const size_t max_size)
+		{
+			return CreateAliasTable(boost::math::negative_binomial_distribution<double>(k, p), epsilon, max_size);
+		});
+
+	return BatchSampler<std::negative_binomial_distribution<IntegerTy>>(distribution, table);
+}
+
+template<typename IntegerTy>
+BatchSampler<std::poisson_distribution<IntegerTy>> CreateBatchSampler(const std::poisson_distribution<IntegerTy>& distribution, AliasTableCache& alias_table_cache)
+{
+	const double mean = distribution.mean();
+
+	auto table = alias_table_cache.GetTable({ mean, 0.0 }, [mean](const double epsilon, const size_t max_size)
+		{
+			return CreateAliasTable(boost::math::poisson_distribution<double>(mean), epsilon, max_size);
+		}, alias_table_cache_friendly_size);
+
+	std::optional<PtrsPoisson> ptrs;
+	if (!table && mean >= PtrsPoisson::min_mean)
+	{
+		ptrs.emplace(mean);
+	}
+
+	return BatchSampler<std::poisson_distribution<IntegerTy>>(distribution, table, ptrs);
+}
+
+template<typename IntegerTy>
+BatchSampler<std::geometric_distribution<IntegerTy>> CreateBatchSampler(const std::geometric_distribution<IntegerTy>& distribution, AliasTableCache& alias_table_cache)
+{
+	const double p = distribution.p();
+
+	auto table = alias_table_cache.GetTable({ p, 0.0 }, [p](const double epsilon, const size_t max_size)
+		{
+			return CreateAliasTable(boost::math::geometric_distribution<double>(p), epsilon, max_size);
+		}, alias_table_cache_friendly_size);
+
+	std::optional<InversionGeometric> inversion;
+	if (!table && p > 0.0 && p < 1.0)
+	{
+		inversion.emplace(p);
+	}
+
+	return BatchSampler<std::geometric_distribution<IntegerTy>>(distribution, table, inversion);
+}
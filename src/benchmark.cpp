@@ -0,0 +1,419 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#include "random_samples.h"
+#include "histogram.h"
+#include "file_io.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <array>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+
+// random_samples_bench [output json file] [number draws]
+//
+// draws: every engine with every distribution of the SamplerCollection
+// in the parameter regimes selecting different samplers,
+// pipeline: DataTable generation, sample functions, histogram fill and file export,
+// every measurement is the fastest of a number of repetitions after a warm up run
+
+
+struct BenchmarkResult
+{
+	std::string group;
+	std::string name;
+	std::string regime;
+	std::string engine;
+	size_t count;
+	double nanoseconds;
+};
+
+
+template<typename SamplingManagerTy>
+using DistributionOf = typename SamplingManagerTy::ParametersTy::distribution_type;
+
+
+// calls function with an engine of engine_type seeded with seed
+template<typename FunctionTy>
+void VisitEngine(const EngineTypes engine_type, const std::uint64_t seed, FunctionTy function)
+{
+	switch (engine_type)
+	{
+	case rdrand32:
+	{
+		rdrand32_Engine engine;
+		function(engine);
+		break;
+	}
+	case xoshiro256ss:
+	{
+		xoshiro256ss_Engine engine(seed);
+		function(engine);
+		break;
+	}
+	case pcg64:
+	{
+		pcg64_Engine engine(seed);
+		function(engine);
+		break;
+	}
+	case splitmix64:
+	{
+		splitmix64_Engine engine(seed);
+		function(engine);
+		break;
+	}
+	case rdrand64_buffered:
+	{
+		rdrand64_buffered_Engine engine;
+		function(engine);
+		break;
+	}
+	case philox4x32:
+	{
+		philox4x32_Engine engine(seed);
+		function(engine);
+		break;
+	}
+	case threefry2x64:
+	{
+		threefry2x64_Engine engine(seed);
+		function(engine);
+		break;
+	}
+	case rdrand_prefilled:
+	{
+		rdrand_prefilled_Engine engine;
+		function(engine);
+		break;
+	}
+	}
+}
+
+
+class Benchmark
+{
+public:
+
+	Benchmark(const size_t number_draws, const size_t repetitions) :
+		number_draws(number_draws),
+		repetitions(repetitions),
+		seed(0x5EED5EED5EED5EEDull)
+	{}
+
+	// nanoseconds of the fastest call
+	template<typename FunctionTy>
+	double Measure(FunctionTy function) const
+	{
+		function();
+
+		double best = std::numeric_limits<double>::infinity();
+
+		for (size_t repetition = 0; repetition < repetitions; ++repetition)
+		{
+			const auto t1 = std::chrono::steady_clock::now();
+			function();
+			const auto t2 = std::chrono::steady_clock::now();
+
+			best = std::min(best, std::chrono::duration<double, std::nano>(t2 - t1).count());
+		}
+
+		return best;
+	}
+
+	// distribution_index selects the name in the SamplerCollection
+	template<typename DistributionTy>
+	void Draws(const DistributionTy& distribution, const size_t distribution_index, const std::string& regime)
+	{
+		using ResultTy = typename DistributionTy::result_type;
+
+		const auto engine_names = GetEngineNames();
+		const std::string name = sampler_collection.GetName(distribution_index);
+
+		// not std::vector, ResultTy may be bool
+		auto values = std::make_unique<ResultTy[]>(number_draws);
+
+		for (size_t engine_index = 0; engine_index < engine_names.size(); ++engine_index)
+		{
+			VisitEngine(static_cast<EngineTypes>(engine_index), seed, [&](auto& engine)
+				{
+					auto sampler = CreateBatchSampler(distribution, alias_table_cache);
+
+					const double nanoseconds = Measure([&]()
+						{
+							sampler.Fill(engine, values.get(), number_draws);
+						});
+
+					AddResult({ "draws", name, regime, engine_names[engine_index], number_draws, nanoseconds });
+				});
+		}
+	}
+
+	// generation and sample functions through the type erased interface of the application
+	void Collection(const size_t number_samples, const size_t sample_size)
+	{
+		const auto engine_names = GetEngineNames();
+		const EngineTypes engine_type = GetDefaultEngineType();
+
+		for (size_t index = 0; index < sampler_collection.GetSize(); ++index)
+		{
+			auto distribution = sampler_collection.GetDistribution(index);
+			distribution->SetSamplerConfig(number_samples, sample_size);
+			distribution->SetEngineType(engine_type);
+			distribution->SetSeed(seed);
+
+			const double nanoseconds = Measure([&]()
+				{
+					distribution->GenerateSamples();
+				});
+
+			AddResult({ "collection", sampler_collection.GetName(index), "default", engine_names[engine_type], number_samples * sample_size, nanoseconds });
+		}
+	}
+
+	void Pipeline(const size_t number_samples, const size_t sample_size)
+	{
+		using RationalTy = SamplerCollection::RationalTy;
+
+		const auto engine_names = GetEngineNames();
+		const std::string name = sampler_collection.GetName(11);
+		const size_t number_values = number_samples * sample_size;
+
+		const auto sampler = CreateBatchSampler(DistributionOf<SamplerCollection::sampler_t11>(0, 1), alias_table_cache);
+
+		DataTable<RationalTy, RationalTy> data_table;
+
+		for (size_t engine_index = 0; engine_index < engine_names.size(); ++engine_index)
+		{
+			const double nanoseconds = Measure([&]()
+				{
+					data_table.GenerateSamples(sampler, number_samples, sample_size, static_cast<EngineTypes>(engine_index), seed);
+				});
+
+			AddResult({ "data table generation", name, "default", engine_names[engine_index], number_values, nanoseconds });
+		}
+
+		const std::string engine_name = engine_names[GetDefaultEngineType()];
+
+		data_table.GenerateSamples(sampler, number_samples, sample_size, GetDefaultEngineType(), seed);
+
+		const double sample_functions_nanoseconds = Measure([&]()
+			{
+				data_table.CalculateSampleFunctionResults();
+			});
+
+		AddResult({ "sample functions", name, "default", engine_name, number_values, sample_functions_nanoseconds });
+
+		const double column_moments_nanoseconds = Measure([&]()
+			{
+				data_table.CalculateColumnMoments();
+			});
+
+		AddResult({ "column moments", name, "default", engine_name, number_values, column_moments_nanoseconds });
+
+		DataTable<RationalTy, RationalTy> mapped_data_table;
+		mapped_data_table.SetStorageFile(std::filesystem::temp_directory_path() / "benchmark.table");
+
+		const double mapped_nanoseconds = Measure([&]()
+			{
+				mapped_data_table.GenerateSamples(sampler, number_samples, sample_size, GetDefaultEngineType(), seed);
+			});
+
+		AddResult({ "mapped data table generation", name, "default", engine_name, number_values, mapped_nanoseconds });
+
+		Histogram histogram;
+		histogram.SetNumberBins(80);
+		std::vector<RationalTy> means = data_table.GetColumnData("mean");
+
+		auto filled_histogram = histogram.SetHistogram(means, -0.5f, 0.5f);
+
+		const double histogram_nanoseconds = Measure([&]()
+			{
+				filled_histogram = histogram.SetHistogram(means, -0.5f, 0.5f);
+			});
+
+		AddResult({ "histogram fill", name, "default", engine_name, means.size(), histogram_nanoseconds });
+
+		SamplerCollection::sampler_t11 sampling_manager(name, rationale_2, std::vector<std::string>{ "mu", "sigma" });
+		sampling_manager.SetSamplerConfig(number_samples, sample_size);
+		sampling_manager.SetSeed(seed);
+		sampling_manager.GenerateSamples();
+
+		const std::filesystem::path export_path = std::filesystem::temp_directory_path() / "random_samples_bench_export.txt";
+
+		const double export_nanoseconds = Measure([&]()
+			{
+				FileOutput file_output(export_path.string());
+				sampling_manager.WriteToFile(file_output);
+			});
+
+		std::filesystem::remove(export_path);
+
+		AddResult({ "file export", name, "default", engine_name, number_values, export_nanoseconds });
+	}
+
+	// the gamma, chi squared, student t and fisher f samplers draw through MarsagliaTsangGamma,
+	// a shape it accepted without being valid would never leave the rejection loop
+	bool RejectsInvalidShapes() const
+	{
+		for (const float alpha : { 0.f, -0.5f, -1.5f, -3.f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN() })
+		{
+			try
+			{
+				MarsagliaTsangGamma<float> gamma(alpha);
+				return false;
+			}
+			catch (const std::domain_error&)
+			{}
+		}
+
+		return true;
+	}
+
+	void WriteJson(std::ostream& stream) const
+	{
+		const std::array<std::string, 3> simd_level_names = { "sse2", "avx2", "avx512" };
+
+		stream << "{\n";
+		stream << "\t\"benchmark\": \"random_samples\",\n";
+		stream << "\t\"simd_level\": \"" << simd_level_names[GetSimdLevel()] << "\",\n";
+		stream << "\t\"rdrand\": " << (GetCpuFeatures().rdrand ? "true" : "false") << ",\n";
+		stream << "\t\"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+		stream << "\t\"number_draws\": " << number_draws << ",\n";
+		stream << "\t\"repetitions\": " << repetitions << ",\n";
+		stream << "\t\"results\": [\n";
+
+		for (size_t index = 0; index < results.size(); ++index)
+		{
+			const BenchmarkResult& result = results[index];
+			const double nanoseconds_per_item = result.nanoseconds / static_cast<double>(result.count);
+
+			stream << "\t\t{ ";
+			stream << "\"group\": \"" << result.group << "\", ";
+			stream << "\"name\": \"" << result.name << "\", ";
+			stream << "\"regime\": \"" << result.regime << "\", ";
+			stream << "\"engine\": \"" << result.engine << "\", ";
+			stream << "\"count\": " << result.count << ", ";
+			stream << "\"ns_per_item\": " << nanoseconds_per_item << ", ";
+			stream << "\"items_per_second\": " << 1e9 / nanoseconds_per_item;
+			stream << (index + 1 < results.size() ? " },\n" : " }\n");
+		}
+
+		stream << "\t]\n";
+		stream << "}\n";
+	}
+
+private:
+
+	void AddResult(const BenchmarkResult& result)
+	{
+		std::printf("%-22s %-18s %-14s %-18s %10.3f ns\n", result.group.c_str(), result.name.c_str(), result.regime.c_str(), result.engine.c_str(), result.nanoseconds / static_cast<double>(result.count));
+		results.push_back(result);
+	}
+
+	const size_t number_draws;
+	const size_t repetitions;
+	const std::uint64_t seed;
+
+	SamplerCollection sampler_collection;
+	AliasTableCache alias_table_cache;
+	std::vector<BenchmarkResult> results;
+};
+
+
+int main(int argc, char* argv[])
+{
+	const std::string output_path = argc > 1 ? argv[1] : "random_samples_bench.json";
+	const size_t number_draws = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : size_t(1) << 20;
+
+	if (number_draws < 100)
+	{
+		std::cerr << "number draws has to be at least 100\n";
+		return EXIT_FAILURE;
+	}
+
+	Benchmark benchmark(number_draws, 5);
+
+	if (!benchmark.RejectsInvalidShapes())
+	{
+		std::cerr << "gamma sampler accepts a shape without a distribution\n";
+		return EXIT_FAILURE;
+	}
+
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t00>(0, 10), 0, "small range");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t00>(0, 1 << 30), 0, "large range");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t01>(0, 1), 1, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t02>(0.3), 2, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t03>(10, 0.3), 3, "alias table");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t03>(100000000, 0.3), 3, "btpe");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t04>(5, 0.5), 4, "alias table");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t04>(1000, 0.001), 4, "std");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t05>(0.3), 5, "alias table");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t05>(0.000001), 5, "inversion");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t06>(4.0), 6, "alias table");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t06>(10000000.0), 6, "ptrs");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t07>(1), 7, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t08>(0.5f, 1), 8, "alpha < 1");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t08>(5, 1), 8, "alpha >= 1");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t09>(1.5f, 1), 9, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t10>(0, 1), 10, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t11>(0, 1), 11, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t12>(0, 1), 12, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t13>(3), 13, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t14>(0, 1), 14, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t15>(5, 10), 15, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t16>(5), 16, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t17>(2, 5), 17, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t17>(0.5f, 0.5f), 17, "u shaped");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t18>(0, 1), 18, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t19>(0, 1), 19, "default");
+	benchmark.Draws(DistributionOf<SamplerCollection::sampler_t20>(1), 20, "default");
+
+	const size_t sample_size = 100;
+	const size_t number_samples = number_draws / sample_size;
+
+	benchmark.Collection(number_samples, sample_size);
+	benchmark.Pipeline(number_samples, sample_size);
+
+	std::ofstream output(output_path, std::ios::trunc);
+	if (!output)
+	{
+		std::cerr << "could not open " << output_path << '\n';
+		return EXIT_FAILURE;
+	}
+
+	benchmark.WriteJson(output);
+	std::cout << "results written to " << output_path << '\n';
+
+	return EXIT_SUCCESS;
+}
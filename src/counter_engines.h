@@ -0,0 +1,209 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "random_engines.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <type_traits>
+
+
+// Salmon et al., Parallel Random Numbers: As Easy as 1, 2, 3.
+// Every output is a pure function of key and counter,
+// Seek(stream, position) jumps to any value in O(1),
+// the sample row is used as stream
+
+
+// Philox4x32-10
+class philox4x32_Engine
+{
+public:
+
+	using result_type = std::uint32_t;
+
+	explicit philox4x32_Engine(const std::uint64_t seed = 0) :
+		key({ static_cast<result_type>(seed), static_cast<result_type>(seed >> 32) })
+	{
+		Seek(0, 0);
+	}
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	void Seek(const std::uint64_t stream, const std::uint64_t position = 0)
+	{
+		this->stream = stream;
+		block_index = position / block.size();
+		Generate();
+		index = static_cast<size_t>(position % block.size());
+	}
+
+	result_type operator()()
+	{
+		if (index == block.size())
+		{
+			++block_index;
+			Generate();
+			index = 0;
+		}
+		return block[index++];
+	}
+
+private:
+
+	void Generate()
+	{
+		std::array<result_type, 4> counter = {
+			static_cast<result_type>(block_index),
+			static_cast<result_type>(block_index >> 32),
+			static_cast<result_type>(stream),
+			static_cast<result_type>(stream >> 32) };
+
+		std::array<result_type, 2> round_key = key;
+
+		for (int round = 0; round < 10; ++round)
+		{
+			if (round > 0)
+			{
+				round_key[0] += 0x9E3779B9u;
+				round_key[1] += 0xBB67AE85u;
+			}
+
+			const std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+			const std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+
+			counter = {
+				static_cast<result_type>(product1 >> 32) ^ counter[1] ^ round_key[0],
+				static_cast<result_type>(product1),
+				static_cast<result_type>(product0 >> 32) ^ counter[3] ^ round_key[1],
+				static_cast<result_type>(product0) };
+		}
+
+		block = counter;
+	}
+
+	std::array<result_type, 2> key;
+	std::array<result_type, 4> block;
+	std::uint64_t stream;
+	std::uint64_t block_index;
+	size_t index;
+};
+
+
+// Threefry2x64-20
+class threefry2x64_Engine
+{
+public:
+
+	using result_type = std::uint64_t;
+
+	explicit threefry2x64_Engine(const std::uint64_t seed = 0) :
+		key({ seed, 0 })
+	{
+		Seek(0, 0);
+	}
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	void Seek(const std::uint64_t stream, const std::uint64_t position = 0)
+	{
+		this->stream = stream;
+		block_index = position / block.size();
+		Generate();
+		index = static_cast<size_t>(position % block.size());
+	}
+
+	result_type operator()()
+	{
+		if (index == block.size())
+		{
+			++block_index;
+			Generate();
+			index = 0;
+		}
+		return block[index++];
+	}
+
+private:
+
+	void Generate()
+	{
+		static constexpr std::array<unsigned int, 8> rotations = { 16, 42, 12, 31, 16, 32, 24, 21 };
+
+		const std::array<result_type, 3> key_schedule = { key[0], key[1], 0x1BD11BDAA9FC1A22ull ^ key[0] ^ key[1] };
+
+		result_type x0 = block_index + key_schedule[0];
+		result_type x1 = stream + key_schedule[1];
+
+		for (unsigned int round = 0; round < 20; ++round)
+		{
+			x0 += x1;
+			x1 = RotateLeft(x1, rotations[round % 8]);
+			x1 ^= x0;
+
+			if (round % 4 == 3)
+			{
+				const unsigned int injection = round / 4 + 1;
+				x0 += key_schedule[injection % 3];
+				x1 += key_schedule[(injection + 1) % 3] + injection;
+			}
+		}
+
+		block = { x0, x1 };
+	}
+
+	std::array<result_type, 2> key;
+	std::array<result_type, 2> block;
+	std::uint64_t stream;
+	std::uint64_t block_index;
+	size_t index;
+};
+
+
+template<typename EngineTy>
+struct IsCounterBased : std::false_type
+{};
+
+template<>
+struct IsCounterBased<philox4x32_Engine> : std::true_type
+{};
+
+template<>
+struct IsCounterBased<threefry2x64_Engine> : std::true_type
+{};
@@ -0,0 +1,138 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+
+// The binary is built for the x86-64 baseline,
+// kernels for wider instruction sets are compiled per function
+// and selected at run time from the features reported by cpuid.
+// MSVC accepts all intrinsics without target attributes.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET(instruction_sets)
+#else
+#define SIMD_TARGET(instruction_sets) __attribute__((target(instruction_sets)))
+#endif
+
+
+enum SimdLevels
+{
+	simd_sse2,
+	simd_avx2,
+	simd_avx512
+};
+
+struct CpuFeatures
+{
+	bool sse2 = false;
+	bool avx2 = false;
+	bool avx512f = false;
+	bool rdrand = false;
+};
+
+
+inline void Cpuid(const unsigned int leaf, const unsigned int subleaf, unsigned int (&registers)[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int values[4];
+	__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (int index = 0; index < 4; ++index)
+	{
+		registers[index] = static_cast<unsigned int>(values[index]);
+	}
+#else
+	if (!__get_cpuid_count(leaf, subleaf, &registers[0], &registers[1], &registers[2], &registers[3]))
+	{
+		registers[0] = registers[1] = registers[2] = registers[3] = 0;
+	}
+#endif
+}
+
+// register state the operating system saves on context switches
+inline std::uint64_t Xgetbv()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	return _xgetbv(0);
+#else
+	unsigned int low;
+	unsigned int high;
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return (static_cast<std::uint64_t>(high) << 32) | low;
+#endif
+}
+
+inline CpuFeatures DetectCpuFeatures()
+{
+	CpuFeatures features;
+
+	unsigned int leaf_0[4];
+	Cpuid(0, 0, leaf_0);
+	const unsigned int max_leaf = leaf_0[0];
+
+	if (max_leaf < 1)
+	{
+		return features;
+	}
+
+	unsigned int leaf_1[4];
+	Cpuid(1, 0, leaf_1);
+
+	features.sse2 = (leaf_1[3] & (1u << 26)) != 0;
+	features.rdrand = (leaf_1[2] & (1u << 30)) != 0;
+
+	const bool osxsave = (leaf_1[2] & (1u << 27)) != 0;
+	const std::uint64_t saved_state = osxsave ? Xgetbv() : 0;
+	const bool ymm_saved = (saved_state & 0x6) == 0x6;
+	const bool zmm_saved = (saved_state & 0xE6) == 0xE6;
+
+	if (max_leaf >= 7)
+	{
+		unsigned int leaf_7[4];
+		Cpuid(7, 0, leaf_7);
+
+		features.avx2 = ymm_saved && (leaf_7[1] & (1u << 5)) != 0;
+		features.avx512f = zmm_saved && (leaf_7[1] & (1u << 16)) != 0;
+	}
+
+	return features;
+}
+
+
+// detected on first use, the result is constant for the process
+inline const CpuFeatures& GetCpuFeatures()
+{
+	static const CpuFeatures features = DetectCpuFeatures();
+	return features;
+}
+
+inline SimdLevels GetSimdLevel()
+{
+	static const SimdLevels level = GetCpuFeatures().avx512f ? simd_avx512 : GetCpuFeatures().avx2 ? simd_avx2 : simd_sse2;
+	return level;
+}
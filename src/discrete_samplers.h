@@ -0,0 +1,351 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "uniform_batch.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <array>
+
+
+// Kachitvichyanukul, Schmeiser, Binomial Random Variate Generation,
+// BTPE for n * min(p, 1 - p) >= 30
+class BtpeBinomial
+{
+public:
+
+	static constexpr double min_mean = 30.0;
+
+	BtpeBinomial(const std::int64_t n, const double p) :
+		n(n),
+		p(p),
+		uniform(closed_open)
+	{
+		r = std::min(p, 1.0 - p);
+		q = 1.0 - r;
+		nrq = static_cast<double>(n) * r * q;
+		fm = static_cast<double>(n) * r + r;
+		m = static_cast<std::int64_t>(std::floor(fm));
+		p1 = std::floor(2.195 * std::sqrt(nrq) - 4.6 * q) + 0.5;
+		xm = static_cast<double>(m) + 0.5;
+		xl = xm - p1;
+		xr = xm + p1;
+		c = 0.134 + 20.5 / (15.3 + static_cast<double>(m));
+
+		double a = (fm - xl) / (fm - xl * r);
+		laml = a * (1.0 + a / 2.0);
+		a = (xr - fm) / (xr * q);
+		lamr = a * (1.0 + a / 2.0);
+
+		p2 = p1 * (1.0 + 2.0 * c);
+		p3 = p2 + c / laml;
+		p4 = p3 + c / lamr;
+	}
+
+	void Reset()
+	{
+		uniform.Reset();
+	}
+
+	template<typename EngineTy>
+	std::int64_t Sample(EngineTy& engine)
+	{
+		const std::int64_t y = SampleMinimum(engine);
+		return p > 0.5 ? n - y : y;
+	}
+
+	template<typename EngineTy, typename IntegerTy>
+	void Fill(EngineTy& engine, IntegerTy* values, const size_t count)
+	{
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = static_cast<IntegerTy>(Sample(engine));
+		}
+	}
+
+private:
+
+	// binomial(n, min(p, 1 - p))
+	template<typename EngineTy>
+	std::int64_t SampleMinimum(EngineTy& engine)
+	{
+		for (;;)
+		{
+			const double u = uniform.Next(engine) * p4;
+			double v = uniform.Next(engine);
+			std::int64_t y;
+
+			// triangular region, immediate acceptance
+			if (u <= p1)
+			{
+				return static_cast<std::int64_t>(std::floor(xm - p1 * v + u));
+			}
+
+			// parallelograms
+			if (u <= p2)
+			{
+				const double x = xl + (u - p1) / c;
+				v = v * c + 1.0 - std::abs(static_cast<double>(m) - x + 0.5) / p1;
+				if (v > 1.0)
+				{
+					continue;
+				}
+				y = static_cast<std::int64_t>(std::floor(x));
+			}
+			// left exponential tail
+			else if (u <= p3)
+			{
+				if (v == 0.0)
+				{
+					continue;
+				}
+				y = static_cast<std::int64_t>(std::floor(xl + std::log(v) / laml));
+				if (y < 0)
+				{
+					continue;
+				}
+				v = v * (u - p2) * laml;
+			}
+			// right exponential tail
+			else
+			{
+				if (v == 0.0)
+				{
+					continue;
+				}
+				y = static_cast<std::int64_t>(std::floor(xr - std::log(v) / lamr));
+				if (y > n)
+				{
+					continue;
+				}
+				v = v * (u - p3) * lamr;
+			}
+
+			if (Accept(y, v))
+			{
+				return y;
+			}
+		}
+	}
+
+	bool Accept(const std::int64_t y, const double v) const
+	{
+		const std::int64_t k = y > m ? y - m : m - y;
+
+		// explicit evaluation of f(y) / f(m)
+		if (k <= 20 || static_cast<double>(k) >= nrq / 2.0 - 1.0)
+		{
+			const double s = r / q;
+			const double a = s * static_cast<double>(n + 1);
+			double f = 1.0;
+
+			if (m < y)
+			{
+				for (std::int64_t i = m + 1; i <= y; ++i)
+				{
+					f *= a / static_cast<double>(i) - s;
+				}
+			}
+			else if (m > y)
+			{
+				for (std::int64_t i = y + 1; i <= m; ++i)
+				{
+					f /= a / static_cast<double>(i) - s;
+				}
+			}
+			return v <= f;
+		}
+
+		// squeeze on log(f(y) / f(m))
+		const double kd = static_cast<double>(k);
+		const double rho = (kd / nrq) * ((kd * (kd / 3.0 + 0.625) + 0.1666666666666667) / nrq + 0.5);
+		const double t = -kd * kd / (2.0 * nrq);
+		const double log_v = std::log(v);
+
+		if (log_v < t - rho)
+		{
+			return true;
+		}
+		if (log_v > t + rho)
+		{
+			return false;
+		}
+
+		// Stirling bound
+		const double nd = static_cast<double>(n);
+		const double md = static_cast<double>(m);
+		const double yd = static_cast<double>(y);
+		const double x1 = yd + 1.0;
+		const double f1 = md + 1.0;
+		const double z = nd + 1.0 - md;
+		const double w = nd - yd + 1.0;
+
+		return log_v <= xm * std::log(f1 / x1) + (nd - md + 0.5) * std::log(z / w) + (yd - md) * std::log(w * r / (x1 * q))
+			+ StirlingCorrection(f1) + StirlingCorrection(z) + StirlingCorrection(x1) + StirlingCorrection(w);
+	}
+
+	static double StirlingCorrection(const double x)
+	{
+		const double x2 = x * x;
+		return (13680.0 - (462.0 - (132.0 - (99.0 - 140.0 / x2) / x2) / x2) / x2) / x / 166320.0;
+	}
+
+	std::int64_t n;
+	double p;
+	double r;
+	double q;
+	double nrq;
+	double fm;
+	std::int64_t m;
+	double p1;
+	double p2;
+	double p3;
+	double p4;
+	double xm;
+	double xl;
+	double xr;
+	double c;
+	double laml;
+	double lamr;
+	UniformBuffer<double> uniform;
+};
+
+
+// Hoermann, The Transformed Rejection Method for Generating Poisson Random Variables,
+// PTRS for mean >= 10
+class PtrsPoisson
+{
+public:
+
+	static constexpr double min_mean = 10.0;
+
+	PtrsPoisson(const double mean) :
+		mean(mean),
+		uniform(closed_open)
+	{
+		const double square_root_mean = std::sqrt(mean);
+
+		log_mean = std::log(mean);
+		b = 0.931 + 2.53 * square_root_mean;
+		a = -0.059 + 0.02483 * b;
+		log_inverse_alpha = std::log(1.1239 + 1.1328 / (b - 3.4));
+		vr = 0.9277 - 3.6224 / (b - 2.0);
+	}
+
+	void Reset()
+	{
+		uniform.Reset();
+	}
+
+	template<typename EngineTy>
+	std::int64_t Sample(EngineTy& engine)
+	{
+		for (;;)
+		{
+			const double u = uniform.Next(engine) - 0.5;
+			const double v = uniform.Next(engine);
+			const double us = 0.5 - std::abs(u);
+			const std::int64_t k = static_cast<std::int64_t>(std::floor((2.0 * a / us + b) * u + mean + 0.43));
+
+			// squeeze
+			if (us >= 0.07 && v <= vr)
+			{
+				return k;
+			}
+
+			if (k < 0 || (us < 0.013 && v > us))
+			{
+				continue;
+			}
+
+			const double kd = static_cast<double>(k);
+			if (std::log(v) + log_inverse_alpha - std::log(a / (us * us) + b) <= -mean + kd * log_mean - std::lgamma(kd + 1.0))
+			{
+				return k;
+			}
+		}
+	}
+
+	template<typename EngineTy, typename IntegerTy>
+	void Fill(EngineTy& engine, IntegerTy* values, const size_t count)
+	{
+		for (size_t index = 0; index < count; ++index)
+		{
+			values[index] = static_cast<IntegerTy>(Sample(engine));
+		}
+	}
+
+private:
+	double mean;
+	double log_mean;
+	double a;
+	double b;
+	double log_inverse_alpha;
+	double vr;
+	UniformBuffer<double> uniform;
+};
+
+
+// failures before the first success by inversion,
+// for small p where an alias table is too large
+class InversionGeometric
+{
+public:
+
+	InversionGeometric(const double p) :
+		inverse_log_q(1.0 / std::log1p(-p))
+	{}
+
+	void Reset()
+	{}
+
+	template<typename EngineTy>
+	std::int64_t Sample(EngineTy& engine)
+	{
+		const double uniform = SampleUniform<double>(engine, open_open);
+		return static_cast<std::int64_t>(std::floor(std::log(uniform) * inverse_log_q));
+	}
+
+	template<typename EngineTy, typename IntegerTy>
+	void Fill(EngineTy& engine, IntegerTy* values, const size_t count)
+	{
+		alignas(64) std::array<double, uniform_batch_size> uniform;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+
+			FillUniform(engine, uniform.data(), batch_count, open_open);
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				values[offset + index] = static_cast<IntegerTy>(std::floor(std::log(uniform[index]) * inverse_log_q));
+			}
+		}
+	}
+
+private:
+	double inverse_log_q;
+};
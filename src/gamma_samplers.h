@@ -0,0 +1,147 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "uniform_batch.h"
+#include "ziggurat.h"
+
+#include <cstddef>
+#include <cmath>
+#include <array>
+#include <stdexcept>
+
+
+// Marsaglia, Tsang, A Simple Method for Generating Gamma Variables,
+// standard gamma(alpha, 1) in blocks: normal and uniform numbers are drawn
+// for a whole block, candidate and squeeze test are branch free loops,
+// only the few lanes failing the squeeze take the logarithmic test or a new draw.
+// alpha < 1 uses gamma(alpha + 1) * U^(1 / alpha),
+// alpha has to be positive and finite, the rejection loop would not end otherwise.
+template<typename RealTy>
+class MarsagliaTsangGamma
+{
+public:
+
+	MarsagliaTsangGamma(const RealTy alpha) :
+		boost_shape(alpha < static_cast<RealTy>(1)),
+		inverse_alpha(static_cast<RealTy>(1) / alpha)
+	{
+		!(alpha > static_cast<RealTy>(0) && std::isfinite(alpha)) ? throw std::domain_error("gamma sampler: requires a positive finite shape") : false;
+
+		const RealTy shape = boost_shape ? alpha + static_cast<RealTy>(1) : alpha;
+
+		d = shape - static_cast<RealTy>(1) / static_cast<RealTy>(3);
+		c = static_cast<RealTy>(1) / std::sqrt(static_cast<RealTy>(9) * d);
+	}
+
+	template<typename EngineTy>
+	RealTy Sample(EngineTy& engine) const
+	{
+		RealTy value = SampleShape(engine);
+
+		if (boost_shape)
+		{
+			const RealTy uniform = SampleUniform<RealTy>(engine, open_open);
+			value *= std::exp(std::log(uniform) * inverse_alpha);
+		}
+
+		return value;
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, RealTy* values, const size_t count) const
+	{
+		alignas(64) std::array<RealTy, uniform_batch_size> normal;
+		alignas(64) std::array<RealTy, uniform_batch_size> uniform;
+		alignas(64) std::array<RealTy, uniform_batch_size> cube;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+			RealTy* batch_values = values + offset;
+
+			ziggurat.Fill(engine, normal.data(), batch_count);
+			FillUniform(engine, uniform.data(), batch_count, open_open);
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				const RealTy t = static_cast<RealTy>(1) + c * normal[index];
+				cube[index] = t * t * t;
+				batch_values[index] = d * cube[index];
+			}
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				const RealTy square = normal[index] * normal[index];
+				const bool squeeze = cube[index] > static_cast<RealTy>(0) && uniform[index] < static_cast<RealTy>(1) - static_cast<RealTy>(0.0331) * square * square;
+
+				if (!squeeze && !Accept(normal[index], uniform[index], cube[index]))
+				{
+					batch_values[index] = SampleShape(engine);
+				}
+			}
+
+			if (boost_shape)
+			{
+				FillUniform(engine, uniform.data(), batch_count, open_open);
+
+				for (size_t index = 0; index < batch_count; ++index)
+				{
+					batch_values[index] *= std::exp(std::log(uniform[index]) * inverse_alpha);
+				}
+			}
+		}
+	}
+
+private:
+
+	bool Accept(const RealTy normal, const RealTy uniform, const RealTy cube) const
+	{
+		return cube > static_cast<RealTy>(0) &&
+			std::log(uniform) < static_cast<RealTy>(0.5) * normal * normal + d * (static_cast<RealTy>(1) - cube + std::log(cube));
+	}
+
+	// gamma(max(alpha, alpha + 1)) one at a time
+	template<typename EngineTy>
+	RealTy SampleShape(EngineTy& engine) const
+	{
+		for (;;)
+		{
+			const RealTy normal = ziggurat.Sample(engine);
+			const RealTy t = static_cast<RealTy>(1) + c * normal;
+			const RealTy cube = t * t * t;
+
+			const RealTy uniform = SampleUniform<RealTy>(engine, open_open);
+
+			if (Accept(normal, uniform, cube))
+			{
+				return d * cube;
+			}
+		}
+	}
+
+	bool boost_shape;
+	RealTy inverse_alpha;
+	RealTy d;
+	RealTy c;
+	ZigguratNormal<RealTy> ziggurat;
+};
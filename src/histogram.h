@@ -21,13 +21,18 @@ See <https://www.gnu.org/licenses/gpl-2.0.txt>.
 
 #pragma once
 
-#include "transform.h"
-
 #include <boost/histogram.hpp>
 #include <boost/histogram/ostream.hpp>
 namespace histogram = boost::histogram;
 
+#include "thread_pool.h"
+
 #include <vector>
+#include <tuple>
+#include <algorithm>
+
+
+using RegularHistogram = histogram::histogram<std::tuple<histogram::axis::regular<>>>;
 
 
 class Histogram
@@ -38,14 +43,50 @@ public:
 		number_bins(20)
 	{}
 
-	template<typename Ty0>
-	auto SetHistogram(std::vector<Ty0>& data, const float lower_limit, const float upper_limit)
+	RegularHistogram MakeHistogram(const float lower_limit, const float upper_limit) const
+	{
+		return histogram::make_histogram(histogram::axis::regular<>(number_bins, lower_limit, upper_limit));
+	}
+
+	// counts every value once, data is a std::vector or a StridedView,
+	// every task fills its own histogram from a block of the data,
+	// the partial histograms are added in block order
+	template<typename DataTy>
+	void AddToHistogram(RegularHistogram& histogram, const DataTy& data) const
+	{
+		const size_t number_blocks = (data.size() + block_size - 1) / block_size;
+		std::vector<RegularHistogram> partial_histograms(number_blocks, histogram);
+
+		GetThreadPool().ParallelFor(number_blocks, [&data, &partial_histograms](const size_t block_index)
+			{
+				auto& partial_histogram = partial_histograms[block_index];
+				partial_histogram.reset();
+
+				const size_t end = std::min(data.size(), (block_index + 1) * block_size);
+
+				for (size_t index = block_index * block_size; index < end; ++index)
+				{
+					partial_histogram(data[index]);
+				}
+			});
+
+		for (const auto& partial_histogram : partial_histograms)
+		{
+			histogram += partial_histogram;
+		}
+	}
+
+	// relative frequencies of the data
+	template<typename DataTy>
+	RegularHistogram SetHistogram(const DataTy& data, const float lower_limit, const float upper_limit) const
 	{
-		const auto axis = histogram::axis::regular<>(number_bins, lower_limit, upper_limit);
-		auto histogram = histogram::make_histogram(axis);
-		const float weight_value = static_cast<float>(1) / static_cast<float>(data.size());
-		histogram.fill(data, histogram::weight(weight_value));
+		RegularHistogram histogram = MakeHistogram(lower_limit, upper_limit);
+		AddToHistogram(histogram, data);
 
+		if (data.size() > 0)
+		{
+			histogram *= 1.0 / static_cast<double>(data.size());
+		}
 		return histogram;
 	}
 
@@ -60,4 +101,8 @@ public:
 	}
 
 	unsigned int number_bins;
+
+private:
+
+	static constexpr size_t block_size = size_t(1) << 16;
 };
\ No newline at end of file
@@ -0,0 +1,846 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "cpu_dispatch.h"
+#include "uniform_batch.h"
+
+#include <boost/math/distributions.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <array>
+#include <vector>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <exception>
+#include <type_traits>
+#include <immintrin.h>
+
+
+// Numerical inversion of a continuous distribution given by pdf and cdf on [lower, upper]:
+// the quantile function of the distribution truncated to [lower, upper]
+// is a cubic Hermite polynomial per interval, the slopes at the knots are 1 / pdf,
+// intervals are halved until the cdf of the interpolated quantiles deviates
+// from u by at most tolerance at u = 1/4, 1/2 and 3/4 of every interval,
+// a guide table selects the interval of u in constant expected time,
+// a table that does not reach the tolerance is not created
+class InverseCdfTable
+{
+public:
+
+	static constexpr double default_tolerance = 1e-10;
+	static constexpr size_t default_max_size = size_t(1) << 18;
+	static constexpr size_t guide_factor = 8;
+
+	InverseCdfTable(const std::function<double(double)>& pdf, const std::function<double(double)>& cdf, const double lower, const double upper, const double tolerance = default_tolerance, const size_t max_size = default_max_size) :
+		lower(lower),
+		upper(upper),
+		max_error(0.0)
+	{
+		if (!(std::isfinite(lower) && std::isfinite(upper) && lower < upper))
+		{
+			throw std::domain_error("inverse cdf table: requires finite lower < upper");
+		}
+
+		const Variable variable = { pdf, cdf, cdf(lower), cdf(upper) - cdf(lower) };
+
+		if (!(variable.cdf_range > 0.0))
+		{
+			throw std::domain_error("inverse cdf table: no probability mass between lower and upper");
+		}
+
+		std::vector<Interval> intervals;
+		CreateIntervals(variable, lower, upper, tolerance, max_size, intervals);
+		AddIntervals(intervals, false);
+
+		Finish();
+	}
+
+	// Where the mass piles up at the upper end of a bounded support, the quantiles differ from it
+	// by less than the resolution of double and the cdf of x can not tell them apart.
+	// The intervals below split are created from x, those above from the mirrored variable
+	// y = reflection - x given by mirrored_pdf and mirrored_cdf on [mirrored_lower, reflection - split],
+	// both variables have the resolution of double near their lower end.
+	// The tolerance holds for the quantiles before they are rounded to x.
+	InverseCdfTable(const std::function<double(double)>& pdf, const std::function<double(double)>& cdf, const double lower, const double split,
+		const std::function<double(double)>& mirrored_pdf, const std::function<double(double)>& mirrored_cdf, const double mirrored_lower, const double reflection,
+		const double tolerance = default_tolerance, const size_t max_size = default_max_size) :
+		lower(lower),
+		upper(reflection - mirrored_lower),
+		max_error(0.0)
+	{
+		const double mirrored_upper = reflection - split;
+
+		if (!(std::isfinite(lower) && std::isfinite(split) && std::isfinite(mirrored_lower) && std::isfinite(reflection) && lower <= split && mirrored_lower <= mirrored_upper && lower < upper))
+		{
+			throw std::domain_error("inverse cdf table: requires finite lower <= split <= reflection - mirrored_lower");
+		}
+
+		// both variables share the probability mass of the whole table,
+		// u of x is 1 - u of y
+		const double mass = cdf(split) - cdf(lower);
+		const double mirrored_mass = mirrored_cdf(mirrored_upper) - mirrored_cdf(mirrored_lower);
+		const double cdf_range = std::max(0.0, mass) + std::max(0.0, mirrored_mass);
+
+		if (!(cdf_range > 0.0))
+		{
+			throw std::domain_error("inverse cdf table: no probability mass between lower and upper");
+		}
+
+		std::vector<Interval> intervals;
+
+		if (lower < split)
+		{
+			CreateIntervals({ pdf, cdf, cdf(lower), cdf_range }, lower, split, tolerance, max_size, intervals);
+			AddIntervals(intervals, false);
+		}
+
+		if (mirrored_lower < mirrored_upper)
+		{
+			intervals.clear();
+			CreateIntervals({ mirrored_pdf, mirrored_cdf, mirrored_cdf(mirrored_lower), cdf_range }, mirrored_lower, mirrored_upper, tolerance, max_size - std::min(max_size, starts.size()), intervals);
+			AddIntervals(intervals, true, reflection);
+		}
+
+		Finish();
+	}
+
+	size_t GetSize() const
+	{
+		return starts.size();
+	}
+
+	// largest deviation of cdf(Quantile(u)) from u found at the test points, at most the tolerance
+	double GetMaxError() const
+	{
+		return max_error;
+	}
+
+	double GetLower() const
+	{
+		return lower;
+	}
+
+	double GetUpper() const
+	{
+		return upper;
+	}
+
+	// u in [0, 1]
+	double Quantile(const double u) const
+	{
+		const std::uint32_t interval = FindInterval(u);
+		return Interpolate(u, interval);
+	}
+
+	template<typename EngineTy>
+	double Sample(EngineTy& engine) const
+	{
+		return Quantile(SampleUniform<double>(engine));
+	}
+
+	template<typename EngineTy, typename RealTy>
+	void Fill(EngineTy& engine, RealTy* values, const size_t count) const
+	{
+		alignas(64) std::array<double, uniform_batch_size> uniforms;
+		alignas(64) InterpolationBatch batch;
+
+		const SimdLevels simd_level = GetSimdLevel();
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+
+			FillUniform(engine, uniforms.data(), batch_count);
+
+			// the lookups copy the coefficients next to each other,
+			// the polynomials are evaluated a vector at a time
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				const std::uint32_t interval = FindInterval(uniforms[index]);
+				const Polynomial& polynomial = polynomials[interval];
+
+				batch.t[index] = (uniforms[index] - starts[interval]) * inverse_widths[interval];
+				batch.coefficients0[index] = polynomial.coefficients[0];
+				batch.coefficients1[index] = polynomial.coefficients[1];
+				batch.coefficients2[index] = polynomial.coefficients[2];
+				batch.coefficients3[index] = polynomial.coefficients[3];
+			}
+
+			size_t index = 0;
+
+			if (simd_level == simd_avx512)
+			{
+				index = EvaluateAvx512(batch, index, batch_count);
+			}
+			if (simd_level >= simd_avx2)
+			{
+				index = EvaluateAvx2(batch, index, batch_count);
+			}
+			index = EvaluateSse2(batch, index, batch_count);
+
+			for (; index < batch_count; ++index)
+			{
+				batch.quantiles[index] = batch.coefficients0[index] + batch.t[index] * (batch.coefficients1[index] + batch.t[index] * (batch.coefficients2[index] + batch.t[index] * batch.coefficients3[index]));
+			}
+
+			for (index = 0; index < batch_count; ++index)
+			{
+				values[offset + index] = static_cast<RealTy>(batch.quantiles[index]);
+			}
+		}
+	}
+
+private:
+
+	// the distribution or its mirror, the cdf is normalized to u by cdf_lower and cdf_range
+	struct Variable
+	{
+		const std::function<double(double)>& pdf;
+		const std::function<double(double)>& cdf;
+		double cdf_lower;
+		double cdf_range;
+	};
+
+	struct Knot
+	{
+		double x;
+		double u;
+		double pdf;
+	};
+
+	struct Polynomial
+	{
+		std::array<double, 4> coefficients;
+
+		double Evaluate(const double t) const
+		{
+			return coefficients[0] + t * (coefficients[1] + t * (coefficients[2] + t * coefficients[3]));
+		}
+	};
+
+	struct Interval
+	{
+		double start;
+		double end;
+		Polynomial polynomial;
+	};
+
+	static Knot CreateKnot(const Variable& variable, const double x)
+	{
+		return { x, (variable.cdf(x) - variable.cdf_lower) / variable.cdf_range, variable.pdf(x) };
+	}
+
+	// x as a polynomial of t = (u - u0) / (u1 - u0),
+	// the secant replaces slopes of knots without finite positive pdf
+	static Polynomial FitHermite(const Variable& variable, const Knot& knot0, const Knot& knot1)
+	{
+		const double width = knot1.x - knot0.x;
+		const double scale = (knot1.u - knot0.u) * variable.cdf_range;
+
+		double slope0 = knot0.pdf > 0.0 ? scale / knot0.pdf : width;
+		double slope1 = knot1.pdf > 0.0 ? scale / knot1.pdf : width;
+		slope0 = std::isfinite(slope0) ? slope0 : width;
+		slope1 = std::isfinite(slope1) ? slope1 : width;
+
+		return { { knot0.x, slope0, 3.0 * width - 2.0 * slope0 - slope1, -2.0 * width + slope0 + slope1 } };
+	}
+
+	static Polynomial FitLinear(const Knot& knot0, const Knot& knot1)
+	{
+		return { { knot0.x, knot1.x - knot0.x, 0.0, 0.0 } };
+	}
+
+	static double GetError(const Variable& variable, const Knot& knot0, const Knot& knot1, const Polynomial& polynomial)
+	{
+		double error = 0.0;
+
+		for (const double t : { 0.25, 0.5, 0.75 })
+		{
+			const double x = polynomial.Evaluate(t);
+			if (!(x >= knot0.x && x <= knot1.x))
+			{
+				return std::numeric_limits<double>::infinity();
+			}
+
+			const double u = knot0.u + t * (knot1.u - knot0.u);
+			error = std::max(error, std::abs((variable.cdf(x) - variable.cdf_lower) / variable.cdf_range - u));
+		}
+
+		return error;
+	}
+
+	// depth first from left to right, pending holds the right knots of unfinished intervals
+	void CreateIntervals(const Variable& variable, const double lower, const double upper, const double tolerance, const size_t max_size, std::vector<Interval>& intervals)
+	{
+		Knot left = CreateKnot(variable, lower);
+		std::vector<Knot> pending = { CreateKnot(variable, upper) };
+
+		while (!pending.empty())
+		{
+			const Knot right = pending.back();
+
+			// intervals without probability mass are never selected
+			if (!(right.u > left.u))
+			{
+				left = right;
+				pending.pop_back();
+				continue;
+			}
+
+			const double middle = left.x + (right.x - left.x) / 2;
+			const bool resolvable = middle > left.x && middle < right.x;
+
+			Polynomial polynomial = FitHermite(variable, left, right);
+			double error = GetError(variable, left, right, polynomial);
+
+			if (error > tolerance && resolvable)
+			{
+				if (intervals.size() + pending.size() >= max_size)
+				{
+					throw std::runtime_error("inverse cdf table: tolerance not reached within the maximal number of intervals");
+				}
+
+				pending.push_back(CreateKnot(variable, middle));
+				continue;
+			}
+
+			// the interval width reached the resolution of double
+			if (!(error <= tolerance))
+			{
+				polynomial = FitLinear(left, right);
+				error = GetError(variable, left, right, polynomial);
+			}
+
+			if (!(error <= tolerance))
+			{
+				throw std::runtime_error("inverse cdf table: tolerance not reached at the resolution of double");
+			}
+
+			intervals.push_back({ left.u, right.u, polynomial });
+			max_error = std::max(max_error, error);
+
+			left = right;
+			pending.pop_back();
+		}
+	}
+
+	// Intervals of the mirrored variable y = reflection - x are added from the upper end of u down,
+	// their u is 1 - u of y and the polynomial is reflection - p(1 - t).
+	void AddIntervals(const std::vector<Interval>& intervals, const bool mirrored, const double reflection = 0.0)
+	{
+		if (!mirrored)
+		{
+			for (const Interval& interval : intervals)
+			{
+				AddInterval(interval.start, interval.end, interval.polynomial);
+			}
+			return;
+		}
+
+		for (auto interval = intervals.crbegin(); interval != intervals.crend(); ++interval)
+		{
+			const auto& coefficients = interval->polynomial.coefficients;
+
+			Polynomial polynomial = { {
+				reflection - (coefficients[0] + coefficients[1] + coefficients[2] + coefficients[3]),
+				coefficients[1] + 2.0 * coefficients[2] + 3.0 * coefficients[3],
+				-(coefficients[2] + 3.0 * coefficients[3]),
+				coefficients[3] } };
+
+			double start = 1.0 - interval->end;
+			const double end = 1.0 - interval->start;
+
+			// the starts stay ordered where both variables meet,
+			// an interval reaching below the last start only keeps its part above it
+			if (!starts.empty() && start < starts.back())
+			{
+				if (!(end > starts.back()))
+				{
+					continue;
+				}
+
+				const double offset = (starts.back() - start) / (end - start);
+				polynomial = Restrict(polynomial, offset, 1.0 - offset);
+				start = starts.back();
+			}
+
+			AddInterval(start, end, polynomial);
+		}
+	}
+
+	// p(offset + scale * t) as a polynomial of t
+	static Polynomial Restrict(const Polynomial& polynomial, const double offset, const double scale)
+	{
+		const auto& coefficients = polynomial.coefficients;
+
+		return { {
+			polynomial.Evaluate(offset),
+			scale * (coefficients[1] + offset * (2.0 * coefficients[2] + offset * 3.0 * coefficients[3])),
+			scale * scale * (coefficients[2] + offset * 3.0 * coefficients[3]),
+			scale * scale * scale * coefficients[3] } };
+	}
+
+	void AddInterval(const double start, const double end, const Polynomial& polynomial)
+	{
+		starts.push_back(start);
+		inverse_widths.push_back(1.0 / (end - start));
+		polynomials.push_back(polynomial);
+	}
+
+	void Finish()
+	{
+		if (starts.empty())
+		{
+			throw std::domain_error("inverse cdf table: no probability mass between lower and upper");
+		}
+
+		starts.front() = 0.0;
+		CreateGuideTable();
+	}
+
+	// guide[j] is the last interval starting at or below j / guide size,
+	// with guide_factor cells per interval most cells hold no interval start
+	// and the search after the lookup rarely takes a step
+	void CreateGuideTable()
+	{
+		const size_t size = starts.size();
+		guide.resize(size * guide_factor);
+
+		std::uint32_t interval = 0;
+		for (size_t index = 0; index < guide.size(); ++index)
+		{
+			const double u = static_cast<double>(index) / static_cast<double>(guide.size());
+			while (interval + 1 < size && starts[interval + 1] <= u)
+			{
+				++interval;
+			}
+			guide[index] = interval;
+		}
+	}
+
+	std::uint32_t FindInterval(const double u) const
+	{
+		const size_t size = starts.size();
+		const size_t guide_index = std::min(static_cast<size_t>(u * static_cast<double>(guide.size())), guide.size() - 1);
+
+		std::uint32_t interval = guide[guide_index];
+		while (interval + 1 < size && u >= starts[interval + 1])
+		{
+			++interval;
+		}
+		return interval;
+	}
+
+	double Interpolate(const double u, const std::uint32_t interval) const
+	{
+		const double t = (u - starts[interval]) * inverse_widths[interval];
+		return polynomials[interval].Evaluate(t);
+	}
+
+	struct InterpolationBatch
+	{
+		std::array<double, uniform_batch_size> t;
+		std::array<double, uniform_batch_size> coefficients0;
+		std::array<double, uniform_batch_size> coefficients1;
+		std::array<double, uniform_batch_size> coefficients2;
+		std::array<double, uniform_batch_size> coefficients3;
+		std::array<double, uniform_batch_size> quantiles;
+	};
+
+	// vector kernels evaluate whole vectors from index on
+	// and return the index of the first value not evaluated
+
+	SIMD_TARGET("avx512f")
+	static size_t EvaluateAvx512(InterpolationBatch& batch, size_t index, const size_t count)
+	{
+		for (; index + 8 <= count; index += 8)
+		{
+			const __m512d t_8 = _mm512_load_pd(batch.t.data() + index);
+
+			__m512d quantile_8 = _mm512_load_pd(batch.coefficients3.data() + index);
+			quantile_8 = _mm512_add_pd(_mm512_load_pd(batch.coefficients2.data() + index), _mm512_mul_pd(t_8, quantile_8));
+			quantile_8 = _mm512_add_pd(_mm512_load_pd(batch.coefficients1.data() + index), _mm512_mul_pd(t_8, quantile_8));
+			quantile_8 = _mm512_add_pd(_mm512_load_pd(batch.coefficients0.data() + index), _mm512_mul_pd(t_8, quantile_8));
+
+			_mm512_store_pd(batch.quantiles.data() + index, quantile_8);
+		}
+		return index;
+	}
+
+	SIMD_TARGET("avx2")
+	static size_t EvaluateAvx2(InterpolationBatch& batch, size_t index, const size_t count)
+	{
+		for (; index + 4 <= count; index += 4)
+		{
+			const __m256d t_4 = _mm256_load_pd(batch.t.data() + index);
+
+			__m256d quantile_4 = _mm256_load_pd(batch.coefficients3.data() + index);
+			quantile_4 = _mm256_add_pd(_mm256_load_pd(batch.coefficients2.data() + index), _mm256_mul_pd(t_4, quantile_4));
+			quantile_4 = _mm256_add_pd(_mm256_load_pd(batch.coefficients1.data() + index), _mm256_mul_pd(t_4, quantile_4));
+			quantile_4 = _mm256_add_pd(_mm256_load_pd(batch.coefficients0.data() + index), _mm256_mul_pd(t_4, quantile_4));
+
+			_mm256_store_pd(batch.quantiles.data() + index, quantile_4);
+		}
+		return index;
+	}
+
+	SIMD_TARGET("sse2")
+	static size_t EvaluateSse2(InterpolationBatch& batch, size_t index, const size_t count)
+	{
+		for (; index + 2 <= count; index += 2)
+		{
+			const __m128d t_2 = _mm_load_pd(batch.t.data() + index);
+
+			__m128d quantile_2 = _mm_load_pd(batch.coefficients3.data() + index);
+			quantile_2 = _mm_add_pd(_mm_load_pd(batch.coefficients2.data() + index), _mm_mul_pd(t_2, quantile_2));
+			quantile_2 = _mm_add_pd(_mm_load_pd(batch.coefficients1.data() + index), _mm_mul_pd(t_2, quantile_2));
+			quantile_2 = _mm_add_pd(_mm_load_pd(batch.coefficients0.data() + index), _mm_mul_pd(t_2, quantile_2));
+
+			_mm_store_pd(batch.quantiles.data() + index, quantile_2);
+		}
+		return index;
+	}
+
+	double lower;
+	double upper;
+	double max_error;
+
+	std::vector<double> starts;
+	std::vector<double> inverse_widths;
+	std::vector<Polynomial> polynomials;
+	std::vector<std::uint32_t> guide;
+};
+
+
+// Distributions on a bounded support with a mirrored distribution of reflection - x,
+// the table takes the intervals above the middle of the support from the mirror.
+template<typename DistributionTy>
+struct MirroredDistribution
+{
+	static constexpr bool exists = false;
+};
+
+template<typename RealTy, typename PolicyTy>
+struct MirroredDistribution<boost::math::beta_distribution<RealTy, PolicyTy>>
+{
+	static constexpr bool exists = true;
+	static constexpr double reflection = 1.0;
+	static constexpr double split = 0.5;
+
+	static boost::math::beta_distribution<RealTy, PolicyTy> Mirror(const boost::math::beta_distribution<RealTy, PolicyTy>& distribution)
+	{
+		return boost::math::beta_distribution<RealTy, PolicyTy>(distribution.beta(), distribution.alpha());
+	}
+};
+
+
+template<typename DistributionTy>
+std::function<double(double)> CreateTablePdf(const DistributionTy& distribution)
+{
+	return [distribution](const double x)
+	{
+		// poles of the density, the knot falls back to the secant
+		try
+		{
+			return static_cast<double>(boost::math::pdf(distribution, x));
+		}
+		catch (const std::overflow_error&)
+		{
+			return std::numeric_limits<double>::infinity();
+		}
+	};
+}
+
+template<typename DistributionTy>
+std::function<double(double)> CreateTableCdf(const DistributionTy& distribution)
+{
+	return [distribution](const double x) { return static_cast<double>(boost::math::cdf(distribution, x)); };
+}
+
+
+// Tables of continuous boost::math distributions,
+// the support is truncated to the quantiles epsilon / 2 and 1 - epsilon / 2
+constexpr double inverse_cdf_table_epsilon = 1e-12;
+
+// the root finding of boost::math gives up on some quantiles deep in a tail,
+// on a finite support the cdf is bisected down to adjacent doubles instead
+template<typename DistributionTy>
+double EvaluateQuantile(const DistributionTy& distribution, const double p)
+{
+	try
+	{
+		return static_cast<double>(boost::math::quantile(distribution, p));
+	}
+	catch (const boost::math::evaluation_error&)
+	{
+		const auto support = boost::math::support(distribution);
+		double lower = static_cast<double>(support.first);
+		double upper = static_cast<double>(support.second);
+
+		if (!(std::isfinite(lower) && std::isfinite(upper)))
+		{
+			throw;
+		}
+
+		for (double middle = lower + (upper - lower) / 2; middle > lower && middle < upper; middle = lower + (upper - lower) / 2)
+		{
+			(boost::math::cdf(distribution, middle) < p ? lower : upper) = middle;
+		}
+		return lower;
+	}
+}
+
+template<typename DistributionTy>
+std::shared_ptr<const InverseCdfTable> CreateInverseCdfTable(const DistributionTy& distribution, const double epsilon = inverse_cdf_table_epsilon, const double tolerance = InverseCdfTable::default_tolerance)
+{
+	const double lower = EvaluateQuantile(distribution, epsilon / 2);
+
+	if constexpr (MirroredDistribution<DistributionTy>::exists)
+	{
+		using MirrorTy = MirroredDistribution<DistributionTy>;
+
+		const auto mirrored_distribution = MirrorTy::Mirror(distribution);
+		const double mirrored_lower = EvaluateQuantile(mirrored_distribution, epsilon / 2);
+		const double split = std::clamp(MirrorTy::split, lower, MirrorTy::reflection - mirrored_lower);
+
+		return std::make_shared<const InverseCdfTable>(CreateTablePdf(distribution), CreateTableCdf(distribution), lower, split,
+			CreateTablePdf(mirrored_distribution), CreateTableCdf(mirrored_distribution), mirrored_lower, MirrorTy::reflection, tolerance);
+	}
+	else
+	{
+		const double upper = boost::math::quantile(boost::math::complement(distribution, epsilon / 2));
+
+		return std::make_shared<const InverseCdfTable>(CreateTablePdf(distribution), CreateTableCdf(distribution), lower, upper, tolerance);
+	}
+}
+
+
+// std style distribution for any continuous boost::math distribution,
+// the NumberParameters first parameters construct BoostDistributionTy,
+// invalid parameters leave the table empty and give quiet NaN.
+// Where the quantiles can not reach the tolerance at the resolution of double the table is not created,
+// the boost::math quantile of the same truncated distribution is evaluated for every value instead.
+template<typename BoostDistributionTy, typename RealTy = double, size_t NumberParameters = 2>
+class TabulatedDistribution
+{
+	static_assert(NumberParameters == 1 || NumberParameters == 2, "tabulated distributions take one or two parameters");
+
+public:
+
+	using result_type = RealTy;
+
+	class param_type
+	{
+	public:
+
+		using distribution_type = TabulatedDistribution;
+
+		explicit param_type(const RealTy parameter0 = RealTy(1), const RealTy parameter1 = RealTy(1)) :
+			parameters({ parameter0, parameter1 })
+		{}
+
+		RealTy GetParameter(const size_t index) const
+		{
+			return parameters[index];
+		}
+
+		bool operator==(const param_type& other) const
+		{
+			return parameters == other.parameters;
+		}
+
+		bool operator!=(const param_type& other) const
+		{
+			return parameters != other.parameters;
+		}
+
+	private:
+		std::array<RealTy, 2> parameters;
+	};
+
+	explicit TabulatedDistribution(const RealTy parameter0 = RealTy(1), const RealTy parameter1 = RealTy(1)) :
+		parameters(parameter0, parameter1)
+	{
+		CreateTable();
+	}
+
+	explicit TabulatedDistribution(const param_type& parameters) :
+		parameters(parameters)
+	{
+		CreateTable();
+	}
+
+	void reset()
+	{}
+
+	param_type param() const
+	{
+		return parameters;
+	}
+
+	// unchanged parameters keep the table
+	void param(const param_type& parameters)
+	{
+		if (parameters != this->parameters)
+		{
+			this->parameters = parameters;
+			CreateTable();
+		}
+	}
+
+	result_type min() const
+	{
+		return IsValid() ? static_cast<RealTy>(bounds[0]) : std::numeric_limits<RealTy>::quiet_NaN();
+	}
+
+	result_type max() const
+	{
+		return IsValid() ? static_cast<RealTy>(bounds[1]) : std::numeric_limits<RealTy>::quiet_NaN();
+	}
+
+	template<typename EngineTy>
+	result_type operator()(EngineTy& engine) const
+	{
+		if (table)
+		{
+			return static_cast<RealTy>(table->Sample(engine));
+		}
+
+		return static_cast<RealTy>(Quantile(SampleUniform<double>(engine, open_open)));
+	}
+
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, RealTy* values, const size_t count) const
+	{
+		if (table)
+		{
+			table->Fill(engine, values, count);
+			return;
+		}
+
+		alignas(64) std::array<double, uniform_batch_size> uniforms;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+
+			FillUniform(engine, uniforms.data(), batch_count, open_open);
+
+			for (size_t index = 0; index < batch_count; ++index)
+			{
+				values[offset + index] = static_cast<RealTy>(Quantile(uniforms[index]));
+			}
+		}
+	}
+
+	// u in [0, 1]
+	double Quantile(const double u) const
+	{
+		if (table)
+		{
+			return table->Quantile(u);
+		}
+
+		return quantile ? quantile(u) : std::numeric_limits<double>::quiet_NaN();
+	}
+
+	// false for invalid parameters
+	bool IsValid() const
+	{
+		return table || quantile;
+	}
+
+	// nullptr for invalid parameters and where the boost::math quantile is evaluated instead
+	std::shared_ptr<const InverseCdfTable> GetTable() const
+	{
+		return table;
+	}
+
+private:
+
+	void CreateTable()
+	{
+		table = nullptr;
+		quantile = nullptr;
+
+		// boost validates the parameters in the constructor
+		std::unique_ptr<BoostDistributionTy> distribution;
+		try
+		{
+			distribution = CreateBoostDistribution();
+		}
+		catch (const std::domain_error&)
+		{
+			return;
+		}
+
+		try
+		{
+			table = CreateInverseCdfTable(*distribution);
+			bounds = { table->GetLower(), table->GetUpper() };
+			return;
+		}
+		catch (const std::runtime_error&)
+		{}
+
+		// u is mapped into the quantiles the table would have been truncated to
+		bounds = { EvaluateQuantile(*distribution, inverse_cdf_table_epsilon / 2), EvaluateQuantile(*distribution, 1.0 - inverse_cdf_table_epsilon / 2) };
+		quantile = [distribution = *distribution](const double u)
+		{
+			return EvaluateQuantile(distribution, inverse_cdf_table_epsilon / 2 + u * (1.0 - inverse_cdf_table_epsilon));
+		};
+	}
+
+	std::unique_ptr<BoostDistributionTy> CreateBoostDistribution() const
+	{
+		const double parameter0 = static_cast<double>(parameters.GetParameter(0));
+		const double parameter1 = static_cast<double>(parameters.GetParameter(1));
+
+		if constexpr (NumberParameters == 1)
+		{
+			return std::make_unique<BoostDistributionTy>(parameter0);
+		}
+		else
+		{
+			return std::make_unique<BoostDistributionTy>(parameter0, parameter1);
+		}
+	}
+
+	param_type parameters;
+	std::shared_ptr<const InverseCdfTable> table;
+	std::function<double(double)> quantile;
+	std::array<double, 2> bounds;
+};
+
+template<typename DistributionTy>
+struct IsTabulatedDistribution : std::false_type
+{};
+
+template<typename BoostDistributionTy, typename RealTy, size_t NumberParameters>
+struct IsTabulatedDistribution<TabulatedDistribution<BoostDistributionTy, RealTy, NumberParameters>> : std::true_type
+{};
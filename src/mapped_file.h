@@ -0,0 +1,206 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+
+// distinguishes the scratch files of processes sharing a directory
+inline unsigned long GetProcessNumber()
+{
+#if defined(_WIN32)
+	return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+	return static_cast<unsigned long>(getpid());
+#endif
+}
+
+
+// A scratch file of a fixed number of bytes mapped into memory, read and write.
+// The operating system pages it in and out, so the mapped size is bounded by the disk.
+// The file is created anew when it is mapped and removed when it is unmapped,
+// its space is reserved on the disk up front, a full disk fails in Map instead of on a later page write.
+class MappedFile
+{
+public:
+
+	MappedFile() :
+		address(nullptr),
+		number_bytes(0)
+#if defined(_WIN32)
+		, file_handle(INVALID_HANDLE_VALUE),
+		mapping_handle(nullptr)
+#endif
+	{}
+
+	~MappedFile()
+	{
+		Unmap();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// the pages are advised for sequential access,
+	// generation writes and export reads the table front to back,
+	// a file left at path is replaced, the new file is created exclusively and never follows a link
+	void Map(const std::filesystem::path& path, const size_t number_bytes)
+	{
+		Unmap();
+
+		std::error_code error;
+		std::filesystem::remove(path, error);
+
+		this->path = path;
+		this->number_bytes = number_bytes;
+
+#if defined(_WIN32)
+		file_handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		file_handle == INVALID_HANDLE_VALUE ? Fail("mapped file: file can not be created") : false;
+
+		if (number_bytes > 0)
+		{
+			FILE_ALLOCATION_INFO allocation;
+			allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(number_bytes);
+			SetFileInformationByHandle(file_handle, FileAllocationInfo, &allocation, sizeof(allocation)) == 0 ? Fail("mapped file: file can not be resized") : false;
+
+			mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<unsigned long long>(number_bytes) >> 32), static_cast<DWORD>(number_bytes), nullptr);
+			mapping_handle == nullptr ? Fail("mapped file: file mapping can not be created") : false;
+
+			address = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, number_bytes);
+			address == nullptr ? Fail("mapped file: view can not be mapped") : false;
+		}
+#else
+		const int file_descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		file_descriptor < 0 ? Fail("mapped file: file can not be created") : false;
+
+		if (number_bytes > 0)
+		{
+			if (posix_fallocate(file_descriptor, 0, static_cast<off_t>(number_bytes)) != 0)
+			{
+				close(file_descriptor);
+				Fail("mapped file: file can not be resized");
+			}
+
+			void* const mapped = mmap(nullptr, number_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+			close(file_descriptor);
+			mapped == MAP_FAILED ? Fail("mapped file: file can not be mapped") : false;
+
+			address = mapped;
+			madvise(address, number_bytes, MADV_SEQUENTIAL);
+		}
+		else
+		{
+			close(file_descriptor);
+		}
+#endif
+	}
+
+	void Unmap()
+	{
+#if defined(_WIN32)
+		if (address != nullptr)
+		{
+			UnmapViewOfFile(address);
+		}
+		if (mapping_handle != nullptr)
+		{
+			CloseHandle(mapping_handle);
+			mapping_handle = nullptr;
+		}
+		if (file_handle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(file_handle);
+			file_handle = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (address != nullptr)
+		{
+			munmap(address, number_bytes);
+		}
+#endif
+		address = nullptr;
+		number_bytes = 0;
+
+		if (!path.empty())
+		{
+			std::error_code error;
+			std::filesystem::remove(path, error);
+			path.clear();
+		}
+	}
+
+	bool IsMapped() const
+	{
+		return !path.empty();
+	}
+
+	void* GetAddress() const
+	{
+		return address;
+	}
+
+	size_t GetNumberBytes() const
+	{
+		return number_bytes;
+	}
+
+	const std::filesystem::path& GetPath() const
+	{
+		return path;
+	}
+
+private:
+
+	// leaves nothing mapped behind
+	bool Fail(const char* message)
+	{
+		Unmap();
+		throw std::runtime_error(message);
+	}
+
+	std::filesystem::path path;
+	void* address;
+	size_t number_bytes;
+
+#if defined(_WIN32)
+	HANDLE file_handle;
+	HANDLE mapping_handle;
+#endif
+};
@@ -33,6 +33,7 @@ namespace math = boost::math;
 #include <array>
 #include <string>
 #include <tuple>
+#include <cstdio>
 
 
 class Plot : public TransformCoordinateSystemInterface
@@ -152,10 +153,7 @@ public:
 			x_axis_ticks.push_back(current_tick);
 
 			float x_value = transform_coordinate_system.ScaleXToPlot(x - plot_rect.l()) + scrolled_axes[0];
-			std::stringstream stream;
-			stream << std::fixed << std::setprecision(decimal_places) << x_value;
-			std::tuple<glm::vec2, std::string> current_label = std::make_tuple(current_tick[1], stream.str());
-			x_axis_labels.push_back(current_label);
+			x_axis_labels.emplace_back(current_tick[1], FormatLabel(x_value, decimal_places));
 		}
 
 		float magic_y = fmodf(-scrolling.y, grid_step.y);
@@ -176,10 +174,7 @@ public:
 			x_axis_ticks.push_back(current_tick);
 
 			float y_value = scrolled_axes[2] - transform_coordinate_system.ScaleYToPlot(y - plot_rect.b());
-			std::stringstream stream;
-			stream << std::fixed << std::setprecision(decimal_places) << y_value;
-			std::tuple<glm::vec2, std::string> current_label = std::make_tuple(current_tick[1], stream.str());
-			y_axis_labels.push_back(current_label);
+			y_axis_labels.emplace_back(current_tick[1], FormatLabel(y_value, decimal_places));
 		}
 	}
 
@@ -191,7 +186,7 @@ public:
 		const size_t steps = 1000;
 		const float step_size = scrolled_axes.Lenght(0, 1) / static_cast<float>(steps);
 
-		std::vector<glm::vec2> pdf_curve(steps);
+		pdf_curve.resize(steps);
 
 		for (size_t index = 0; index < steps; ++index)
 		{
@@ -213,7 +208,7 @@ public:
 	}
 
 
-	void SetHistogram(const histogram::histogram<std::tuple<histogram::axis::regular<>>>& histogram)
+	void SetHistogram(const RegularHistogram& histogram)
 	{
 		bin_array.clear();
 
@@ -323,6 +318,14 @@ public:
 
 private:
 
+	// short labels fit into the small string buffer, formatting them does not allocate
+	static std::string FormatLabel(const float value, const int decimal_places)
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.*f", decimal_places, value);
+		return std::string(buffer);
+	}
+
 	rect4f canvas_rect;
 	rect4f plot_rect;
 
@@ -357,6 +360,7 @@ private:
 	std::vector<std::tuple<glm::vec2, std::string>> x_axis_labels;
 	std::vector<std::tuple<glm::vec2, std::string>> y_axis_labels;
 
+	std::vector<glm::vec2> pdf_curve;
 	std::vector<ImVec2> transformed_curve;
 	std::vector<std::array<glm::vec2, 2>> bin_array;
 };
@@ -0,0 +1,220 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "inverse_cdf_table.h"
+
+#include <boost/math/distributions/binomial.hpp>
+#include <boost/math/distributions/negative_binomial.hpp>
+#include <boost/math/distributions/poisson.hpp>
+#include <boost/math/distributions/geometric.hpp>
+#include <boost/math/distributions/exponential.hpp>
+#include <boost/math/distributions/gamma.hpp>
+#include <boost/math/distributions/weibull.hpp>
+#include <boost/math/distributions/extreme_value.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <boost/math/distributions/lognormal.hpp>
+#include <boost/math/distributions/chi_squared.hpp>
+#include <boost/math/distributions/cauchy.hpp>
+#include <boost/math/distributions/fisher_f.hpp>
+#include <boost/math/distributions/students_t.hpp>
+
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+
+// Quantile function of each std distribution, u in (0, 1),
+// discrete distributions return the smallest k with cdf(k) >= u.
+// The boost::math distributions are constructed here,
+// invalid parameters throw std::domain_error before any sampling thread starts,
+// overflows during sampling return infinity instead of throwing.
+
+template<typename ResultTy>
+using QuantileFunction = std::function<ResultTy(double)>;
+
+using ContinuousQuantilePolicy = boost::math::policies::policy<
+	boost::math::policies::overflow_error<boost::math::policies::errno_on_error>,
+	boost::math::policies::evaluation_error<boost::math::policies::errno_on_error>>;
+
+using DiscreteQuantilePolicy = boost::math::policies::policy<
+	boost::math::policies::overflow_error<boost::math::policies::errno_on_error>,
+	boost::math::policies::evaluation_error<boost::math::policies::errno_on_error>,
+	boost::math::policies::discrete_quantile<boost::math::policies::integer_round_up>>;
+
+
+template<typename IntegerTy>
+QuantileFunction<IntegerTy> CreateQuantileFunction(const std::uniform_int_distribution<IntegerTy>& distribution)
+{
+	const double a = static_cast<double>(distribution.a());
+	const double b = static_cast<double>(distribution.b());
+
+	return [a, b](const double u)
+	{
+		return static_cast<IntegerTy>(std::min(std::floor(a + u * (b - a + 1.0)), b));
+	};
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::uniform_real_distribution<RealTy>& distribution)
+{
+	const double a = static_cast<double>(distribution.a());
+	const double b = static_cast<double>(distribution.b());
+
+	return [a, b](const double u)
+	{
+		return static_cast<RealTy>(a + u * (b - a));
+	};
+}
+
+inline QuantileFunction<bool> CreateQuantileFunction(const std::bernoulli_distribution& distribution)
+{
+	const double p = distribution.p();
+
+	return [p](const double u)
+	{
+		return u > 1.0 - p;
+	};
+}
+
+// DistributionTy boost::math distribution,
+// ResultTy result type of the std distribution
+template<typename ResultTy, typename DistributionTy>
+QuantileFunction<ResultTy> CreateBoostQuantileFunction(const DistributionTy& distribution)
+{
+	return [distribution](const double u)
+	{
+		return static_cast<ResultTy>(boost::math::quantile(distribution, u));
+	};
+}
+
+template<typename IntegerTy>
+QuantileFunction<IntegerTy> CreateQuantileFunction(const std::binomial_distribution<IntegerTy>& distribution)
+{
+	return CreateBoostQuantileFunction<IntegerTy>(boost::math::binomial_distribution<double, DiscreteQuantilePolicy>(static_cast<double>(distribution.t()), distribution.p()));
+}
+
+template<typename IntegerTy>
+QuantileFunction<IntegerTy> CreateQuantileFunction(const std::negative_binomial_distribution<IntegerTy>& distribution)
+{
+	return CreateBoostQuantileFunction<IntegerTy>(boost::math::negative_binomial_distribution<double, DiscreteQuantilePolicy>(static_cast<double>(distribution.k()), distribution.p()));
+}
+
+// closed form, boost::math rounds the geometric quantile up by one more
+template<typename IntegerTy>
+QuantileFunction<IntegerTy> CreateQuantileFunction(const std::geometric_distribution<IntegerTy>& distribution)
+{
+	const double p = distribution.p();
+	if (!(p > 0.0 && p <= 1.0))
+	{
+		throw std::domain_error("geometric distribution requires 0 < p <= 1");
+	}
+
+	const double inverse_log_q = p < 1.0 ? 1.0 / std::log1p(-p) : 0.0;
+
+	return [inverse_log_q](const double u)
+	{
+		return static_cast<IntegerTy>(std::max(std::ceil(std::log1p(-u) * inverse_log_q) - 1.0, 0.0));
+	};
+}
+
+template<typename IntegerTy>
+QuantileFunction<IntegerTy> CreateQuantileFunction(const std::poisson_distribution<IntegerTy>& distribution)
+{
+	return CreateBoostQuantileFunction<IntegerTy>(boost::math::poisson_distribution<double, DiscreteQuantilePolicy>(distribution.mean()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::exponential_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::exponential_distribution<double, ContinuousQuantilePolicy>(distribution.lambda()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::gamma_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::gamma_distribution<double, ContinuousQuantilePolicy>(distribution.alpha(), distribution.beta()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::weibull_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::weibull_distribution<double, ContinuousQuantilePolicy>(distribution.a(), distribution.b()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::extreme_value_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::extreme_value_distribution<double, ContinuousQuantilePolicy>(distribution.a(), distribution.b()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::normal_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::normal_distribution<double, ContinuousQuantilePolicy>(distribution.mean(), distribution.stddev()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::lognormal_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::lognormal_distribution<double, ContinuousQuantilePolicy>(distribution.m(), distribution.s()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::chi_squared_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::chi_squared_distribution<double, ContinuousQuantilePolicy>(distribution.n()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::cauchy_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::cauchy_distribution<double, ContinuousQuantilePolicy>(distribution.a(), distribution.b()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::fisher_f_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::fisher_f_distribution<double, ContinuousQuantilePolicy>(distribution.m(), distribution.n()));
+}
+
+template<typename RealTy>
+QuantileFunction<RealTy> CreateQuantileFunction(const std::student_t_distribution<RealTy>& distribution)
+{
+	return CreateBoostQuantileFunction<RealTy>(boost::math::students_t_distribution<double, ContinuousQuantilePolicy>(distribution.n()));
+}
+
+template<typename BoostDistributionTy, typename RealTy, size_t NumberParameters>
+QuantileFunction<RealTy> CreateQuantileFunction(const TabulatedDistribution<BoostDistributionTy, RealTy, NumberParameters>& distribution)
+{
+	if (!distribution.IsValid())
+	{
+		throw std::domain_error("tabulated distribution has invalid parameters");
+	}
+
+	return [distribution](const double u)
+	{
+		return static_cast<RealTy>(distribution.Quantile(u));
+	};
+}
@@ -0,0 +1,459 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "random_engines.h"
+#include "quantile_functions.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+
+
+// Pseudo random rows or quasi random rows,
+// row i of a quasi random table is point i of the sequence,
+// column j its coordinate j mapped through the quantile function
+enum SamplingModes
+{
+	pseudo_random,
+	sobol,
+	halton
+};
+
+inline std::array<std::string, 3> GetSamplingModeNames()
+{
+	return { "pseudo random", "sobol", "halton" };
+}
+
+
+// Sobol sequence with 32 bit coordinates and Owen scrambling.
+// Primitive polynomials are enumerated by degree and coefficients,
+// which is the order of the Joe Kuo tables, dimensions 2 to 16 use
+// their initial direction numbers, higher dimensions odd numbers from splitmix64.
+// Points are visited in Gray code order, consecutive rows update
+// one direction number per coordinate.
+class SobolSequence
+{
+public:
+
+	static constexpr unsigned int number_bits = 32;
+
+	SobolSequence(const size_t number_dimensions, const std::uint64_t seed) :
+		direction_numbers(number_dimensions),
+		scramble_seeds(number_dimensions)
+	{
+		InitializeDirectionNumbers();
+
+		splitmix64_Engine seed_sequence(seed);
+		for (auto& scramble_seed : scramble_seeds)
+		{
+			scramble_seed = static_cast<std::uint32_t>(seed_sequence());
+		}
+	}
+
+	size_t GetNumberDimensions() const
+	{
+		return direction_numbers.size();
+	}
+
+	// unscrambled coordinates of point index
+	void GetPoint(const std::uint64_t index, std::uint32_t* coordinates, const size_t count) const
+	{
+		const std::uint64_t gray_code = index ^ (index >> 1);
+
+		for (size_t dimension = 0; dimension < count; ++dimension)
+		{
+			std::uint32_t coordinate = 0;
+			for (unsigned int bit = 0; bit < number_bits; ++bit)
+			{
+				if (gray_code & (std::uint64_t(1) << bit))
+				{
+					coordinate ^= direction_numbers[dimension][bit];
+				}
+			}
+			coordinates[dimension] = coordinate;
+		}
+	}
+
+	// coordinates of point index - 1 to point index
+	void NextPoint(const std::uint64_t index, std::uint32_t* coordinates, const size_t count) const
+	{
+		unsigned int bit = 0;
+		while (bit + 1 < number_bits && !(index & (std::uint64_t(1) << bit)))
+		{
+			++bit;
+		}
+
+		for (size_t dimension = 0; dimension < count; ++dimension)
+		{
+			coordinates[dimension] ^= direction_numbers[dimension][bit];
+		}
+	}
+
+	// u in (0, 1)
+	void ToUniform(const std::uint32_t* coordinates, double* values, const size_t count) const
+	{
+		for (size_t dimension = 0; dimension < count; ++dimension)
+		{
+			const std::uint32_t scrambled = OwenScramble(coordinates[dimension], scramble_seeds[dimension]);
+			values[dimension] = (static_cast<double>(scrambled) + 0.5) * 0x1.0p-32;
+		}
+	}
+
+private:
+
+	// Burley, Practical Hash-based Owen Scrambling,
+	// products and sums only carry towards higher bits,
+	// applied to the reversed value every bit is flipped
+	// depending on the bits above it as in nested uniform scrambling
+	static std::uint32_t OwenScramble(std::uint32_t value, const std::uint32_t seed)
+	{
+		value = ReverseBits(value);
+		value ^= value * 0x3D20ADEAu;
+		value += seed;
+		value *= (seed >> 16) | 1u;
+		value ^= value * 0x05526C56u;
+		value ^= value * 0x53A22864u;
+		return ReverseBits(value);
+	}
+
+	static std::uint32_t ReverseBits(std::uint32_t value)
+	{
+		value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+		value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+		value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+		value = ((value >> 8) & 0x00FF00FFu) | ((value & 0x00FF00FFu) << 8);
+		return (value >> 16) | (value << 16);
+	}
+
+	void InitializeDirectionNumbers()
+	{
+		// degree 1 to 6 initial numbers of the dimensions 2 to 16
+		static const std::array<std::vector<std::uint32_t>, 15> initial_numbers = { {
+			{ 1 }, { 1, 3 }, { 1, 3, 1 }, { 1, 1, 1 }, { 1, 1, 3, 3 },
+			{ 1, 3, 5, 13 }, { 1, 1, 5, 5, 17 }, { 1, 1, 5, 5, 5 }, { 1, 1, 7, 11, 19 }, { 1, 1, 5, 1, 1 },
+			{ 1, 1, 1, 3, 11 }, { 1, 3, 5, 5, 31 }, { 1, 3, 3, 9, 7, 49 }, { 1, 1, 1, 15, 21, 21 }, { 1, 3, 1, 13, 27, 49 }
+		} };
+
+		if (direction_numbers.empty())
+		{
+			return;
+		}
+
+		// first dimension, van der Corput sequence
+		for (unsigned int bit = 0; bit < number_bits; ++bit)
+		{
+			direction_numbers[0][bit] = std::uint32_t(1) << (number_bits - 1 - bit);
+		}
+
+		splitmix64_Engine initial_number_sequence(0);
+		unsigned int degree = 1;
+		std::uint32_t coefficients = 0;
+
+		for (size_t dimension = 1; dimension < direction_numbers.size(); ++dimension)
+		{
+			while (!IsPrimitivePolynomial(GetPolynomial(degree, coefficients), degree))
+			{
+				NextCandidate(degree, coefficients);
+			}
+
+			std::array<std::uint32_t, number_bits>& numbers = direction_numbers[dimension];
+
+			for (unsigned int bit = 0; bit < degree && bit < number_bits; ++bit)
+			{
+				std::uint32_t initial_number;
+				if (dimension - 1 < initial_numbers.size())
+				{
+					initial_number = initial_numbers[dimension - 1][bit];
+				}
+				else
+				{
+					// odd and below 2^(bit + 1)
+					initial_number = (static_cast<std::uint32_t>(initial_number_sequence()) & ((std::uint32_t(2) << bit) - 1)) | 1u;
+				}
+				numbers[bit] = initial_number << (number_bits - 1 - bit);
+			}
+
+			for (unsigned int bit = degree; bit < number_bits; ++bit)
+			{
+				std::uint32_t number = numbers[bit - degree] ^ (numbers[bit - degree] >> degree);
+				for (unsigned int term = 1; term < degree; ++term)
+				{
+					if ((coefficients >> (degree - 1 - term)) & 1u)
+					{
+						number ^= numbers[bit - term];
+					}
+				}
+				numbers[bit] = number;
+			}
+
+			NextCandidate(degree, coefficients);
+		}
+	}
+
+	// x^degree + a_1 x^(degree - 1) + ... + a_(degree - 1) x + 1,
+	// coefficients holds a_1 ... a_(degree - 1) from high to low bit
+	static std::uint64_t GetPolynomial(const unsigned int degree, const std::uint32_t coefficients)
+	{
+		return (std::uint64_t(1) << degree) | (std::uint64_t(coefficients) << 1) | 1u;
+	}
+
+	static void NextCandidate(unsigned int& degree, std::uint32_t& coefficients)
+	{
+		++coefficients;
+		if (coefficients >= (std::uint32_t(1) << (degree - 1)))
+		{
+			++degree;
+			coefficients = 0;
+		}
+	}
+
+	static std::uint64_t MultiplyModulo(std::uint64_t lhs, std::uint64_t rhs, const std::uint64_t polynomial, const unsigned int degree)
+	{
+		std::uint64_t product = 0;
+		while (rhs)
+		{
+			if (rhs & 1u)
+			{
+				product ^= lhs;
+			}
+			rhs >>= 1;
+			lhs <<= 1;
+			if (lhs & (std::uint64_t(1) << degree))
+			{
+				lhs ^= polynomial;
+			}
+		}
+		return product;
+	}
+
+	// x^exponent modulo polynomial
+	static std::uint64_t PowerOfX(std::uint64_t exponent, const std::uint64_t polynomial, const unsigned int degree)
+	{
+		std::uint64_t result = 1;
+		std::uint64_t base = degree == 1 ? 1 : 2;
+		while (exponent)
+		{
+			if (exponent & 1u)
+			{
+				result = MultiplyModulo(result, base, polynomial, degree);
+			}
+			base = MultiplyModulo(base, base, polynomial, degree);
+			exponent >>= 1;
+		}
+		return result;
+	}
+
+	// x has the maximal order 2^degree - 1 modulo polynomial
+	static bool IsPrimitivePolynomial(const std::uint64_t polynomial, const unsigned int degree)
+	{
+		const std::uint64_t order = (std::uint64_t(1) << degree) - 1;
+
+		if (PowerOfX(order, polynomial, degree) != 1)
+		{
+			return false;
+		}
+
+		std::uint64_t rest = order;
+		for (std::uint64_t factor = 2; factor * factor <= rest; ++factor)
+		{
+			if (rest % factor == 0)
+			{
+				if (PowerOfX(order / factor, polynomial, degree) == 1)
+				{
+					return false;
+				}
+				while (rest % factor == 0)
+				{
+					rest /= factor;
+				}
+			}
+		}
+		if (rest > 1 && PowerOfX(order / rest, polynomial, degree) == 1)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	std::vector<std::array<std::uint32_t, number_bits>> direction_numbers;
+	std::vector<std::uint32_t> scramble_seeds;
+};
+
+
+// Halton sequence, dimension j uses the j-th prime as base,
+// every digit gets its own random shift modulo the base
+class HaltonSequence
+{
+public:
+
+	HaltonSequence(const size_t number_dimensions, const std::uint64_t seed) :
+		bases(number_dimensions),
+		digit_shifts(number_dimensions)
+	{
+		std::uint32_t candidate = 2;
+		for (auto& base : bases)
+		{
+			while (!IsPrime(candidate))
+			{
+				++candidate;
+			}
+			base = candidate++;
+		}
+
+		splitmix64_Engine seed_sequence(seed);
+		for (size_t dimension = 0; dimension < number_dimensions; ++dimension)
+		{
+			const size_t number_digits = GetNumberDigits(bases[dimension]);
+			digit_shifts[dimension].resize(number_digits);
+			for (auto& shift : digit_shifts[dimension])
+			{
+				shift = static_cast<std::uint32_t>(seed_sequence() % bases[dimension]);
+			}
+		}
+	}
+
+	size_t GetNumberDimensions() const
+	{
+		return bases.size();
+	}
+
+	// u in (0, 1)
+	void GetPoint(std::uint64_t index, double* values, const size_t count) const
+	{
+		for (size_t dimension = 0; dimension < count; ++dimension)
+		{
+			const std::uint64_t base = bases[dimension];
+			const double inverse_base = 1.0 / static_cast<double>(base);
+			const std::vector<std::uint32_t>& shifts = digit_shifts[dimension];
+
+			std::uint64_t rest = index;
+			double scale = inverse_base;
+			double value = 0.0;
+
+			for (const std::uint32_t shift : shifts)
+			{
+				const std::uint64_t digit = (rest % base + shift) % base;
+				value += static_cast<double>(digit) * scale;
+				rest /= base;
+				scale *= inverse_base;
+			}
+
+			values[dimension] = std::clamp(value, 0x1.0p-53, 1.0 - 0x1.0p-53);
+		}
+	}
+
+private:
+
+	// digits up to double resolution
+	static size_t GetNumberDigits(const std::uint32_t base)
+	{
+		return static_cast<size_t>(std::ceil(53.0 * std::log(2.0) / std::log(static_cast<double>(base))));
+	}
+
+	static bool IsPrime(const std::uint32_t candidate)
+	{
+		for (std::uint32_t divisor = 2; divisor * divisor <= candidate; ++divisor)
+		{
+			if (candidate % divisor == 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::vector<std::uint32_t> bases;
+	std::vector<std::vector<std::uint32_t>> digit_shifts;
+};
+
+
+// values of consecutive points of a quasi random sequence
+// mapped through the quantile function of DistributionTy,
+// copies share the sequence tables
+template<typename DistributionTy>
+class QuasiRandomSampler
+{
+public:
+
+	using ResultTy = typename DistributionTy::result_type;
+
+	QuasiRandomSampler(const DistributionTy& distribution, const SamplingModes sampling_mode, const size_t number_dimensions, const std::uint64_t seed) :
+		quantile(CreateQuantileFunction(distribution)),
+		next_index(0)
+	{
+		if (sampling_mode == halton)
+		{
+			halton_sequence = std::make_shared<const HaltonSequence>(number_dimensions, seed);
+		}
+		else
+		{
+			sobol_sequence = std::make_shared<const SobolSequence>(number_dimensions, seed);
+		}
+	}
+
+	// coordinates of point index, count up to the number of dimensions
+	void Fill(const std::uint64_t index, ResultTy* values, const size_t count)
+	{
+		uniform.resize(count);
+
+		if (sobol_sequence)
+		{
+			coordinates.resize(count);
+
+			if (index == next_index && index != 0)
+			{
+				sobol_sequence->NextPoint(index, coordinates.data(), count);
+			}
+			else
+			{
+				sobol_sequence->GetPoint(index, coordinates.data(), count);
+			}
+			next_index = index + 1;
+
+			sobol_sequence->ToUniform(coordinates.data(), uniform.data(), count);
+		}
+		else
+		{
+			halton_sequence->GetPoint(index, uniform.data(), count);
+		}
+
+		for (size_t dimension = 0; dimension < count; ++dimension)
+		{
+			values[dimension] = quantile(uniform[dimension]);
+		}
+	}
+
+private:
+	QuantileFunction<ResultTy> quantile;
+	std::shared_ptr<const SobolSequence> sobol_sequence;
+	std::shared_ptr<const HaltonSequence> halton_sequence;
+	std::uint64_t next_index;
+	std::vector<std::uint32_t> coordinates;
+	std::vector<double> uniform;
+};
@@ -22,40 +22,79 @@ See <https://www.gnu.org/licenses/gpl-2.0.txt>.
 #pragma once
 
 #include "random_numbers.h"
-
-#include <variant>
+#include "quasi_random.h"
+#include "thread_pool.h"
+#include "reduction_kernels.h"
+#include "strided_view.h"
+#include "background_job.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
 
 
 
 // Ty0 sample variables, 
-// Ty1 sample function results variables
+// Ty1 sample function results variables,
+// the reductions run on the kernels of reduction_kernels.h in double precision
 template<typename Ty0, typename Ty1>
 class SampleFunctions
 {
 public:
 
-	Ty1 Sum(const std::vector<Ty0>& sample_variables) const
+	Ty1 Sum(const Ty0* sample_variables, const size_t sample_size) const
 	{
-		const Ty1 sum = static_cast<Ty1>(std::accumulate(sample_variables.cbegin(), sample_variables.cend(), static_cast<Ty0>(0)));
-		return sum;
+		return static_cast<Ty1>(ReduceRow(sample_variables, sample_size).Sum());
 	}
 
-	Ty1 Mean(const std::vector<Ty0>& sample_variables) const
+	Ty1 Mean(const Ty0* sample_variables, const size_t sample_size) const
 	{
-		const Ty1 size = static_cast<Ty1>(sample_variables.size());
-		const Ty1 mean = Sum(sample_variables) / size;
-		return mean;
+		return static_cast<Ty1>(ReduceRow(sample_variables, sample_size).mean);
 	}
 
-	Ty1 TotalSumOfSquares(const std::vector<Ty0>& sample_variables, Ty1 sample_mean) const
+	// deviations from the own mean plus the shift to sample_mean
+	Ty1 TotalSumOfSquares(const Ty0* sample_variables, const size_t sample_size, Ty1 sample_mean) const
 	{
-		Ty1 totalsumofsquares = 0;
-		for (const auto& variable : sample_variables)
-		{
-			totalsumofsquares += std::pow(variable - sample_mean, 2);
-		}
+		const CentralMoments central_moments = ReduceRow(sample_variables, sample_size);
+		const double shift = central_moments.mean - static_cast<double>(sample_mean);
+
+		return static_cast<Ty1>(central_moments.m2 + central_moments.count * shift * shift);
+	}
 
-		return totalsumofsquares;
+	struct Moments
+	{
+		Ty1 sum;
+		Ty1 mean;
+		Ty1 totalsumofsquares;
+		Ty1 min;
+		Ty1 max;
+		Ty1 skewness;
+		Ty1 kurtosis;
+	};
+
+	// one pass over the sample, see ReduceRow
+	Moments CalculateMoments(const Ty0* sample_variables, const size_t sample_size) const
+	{
+		const CentralMoments central_moments = ReduceRow(sample_variables, sample_size);
+
+		Moments moments;
+		moments.sum = static_cast<Ty1>(central_moments.Sum());
+		moments.mean = static_cast<Ty1>(central_moments.mean);
+		moments.totalsumofsquares = static_cast<Ty1>(central_moments.m2);
+		moments.min = static_cast<Ty1>(central_moments.min);
+		moments.max = static_cast<Ty1>(central_moments.max);
+		moments.skewness = Skewness(central_moments);
+		moments.kurtosis = Kurtosis(central_moments);
+
+		return moments;
 	}
 
 	Ty1 Variance(Ty1 totalsumofsquares, Ty1 sample_size) const
@@ -67,6 +106,26 @@ public:
 	{
 		return std::sqrt(sample_variance);
 	}
+
+	// sample skewness g1, zero for constant samples
+	Ty1 Skewness(const CentralMoments& central_moments) const
+	{
+		if (central_moments.m2 <= 0)
+		{
+			return 0;
+		}
+		return static_cast<Ty1>(std::sqrt(central_moments.count) * central_moments.m3 / std::pow(central_moments.m2, 1.5));
+	}
+
+	// sample excess kurtosis g2, zero for constant samples
+	Ty1 Kurtosis(const CentralMoments& central_moments) const
+	{
+		if (central_moments.m2 <= 0)
+		{
+			return 0;
+		}
+		return static_cast<Ty1>(central_moments.count * central_moments.m4 / (central_moments.m2 * central_moments.m2) - 3);
+	}
 };
 
 
@@ -93,253 +152,658 @@ struct VisitDataTable
 
 
 // Ty0 sample variables type,
-// Ty1 sample function results variables type
+// Ty1 sample function results variables type,
+// the samples are one dense row major matrix, a row is one sample,
+// every sample function has its own column,
+// the column names are kept apart from the values,
+// the matrix and the columns live on the heap or in a memory mapped storage file
 template<typename Ty0, typename Ty1>
 class DataTable
 {
 public:
 
-	// avoid type duplicate
-	// for variant template arguments
-	using VariantType = typename std::conditional<
-		std::is_same<Ty0, Ty1>::value,
-		std::variant<Ty0, std::string>,
-		std::variant<Ty0, Ty1, std::string>
-	>::type;
-
 	DataTable() :
-		sample_function_results_columns(5),
-		number_name_rows(1),
-		number_columns(0),
-		number_rows(0),
+		sample_function_results_columns(9),
 		number_samples(0),
-		sample_size(0)
+		sample_size(0),
+		storage_capacity(0),
+		row_capacity(0),
+		sample_values(nullptr),
+		row_offset(0),
+		generation(0)
 	{
-		//std::cout << "variable type " << typeid(T).name() << '\n';
-
-		
+		sample_function_names = { "sum", "mean", "tts", "variance1", "variance2", "min", "max", "skewness", "kurtosis" };
 	}
 
+	// seed is the master seed for all seedable engines,
+	// every chunk of rows draws from its own substream of the seed,
+	// with counter based engines every row only depends on seed and row index,
+	// with a job_control every chunk is one step and a cancelled job leaves the remaining chunks unfilled
 	template<typename V>
-	void GenerateSamples(const V& random_distribution, size_t number_samples, size_t sample_size)
+	void GenerateSamples(const BatchSampler<V>& sampler, size_t number_samples, size_t sample_size, const EngineTypes engine_type, const std::uint64_t seed, JobControl* job_control = nullptr)
 	{
 		SetSize(number_samples, sample_size);
+		GenerateWindows(sampler, number_samples, engine_type, seed, job_control, [](const size_t) {});
+	}
 
+	// Streaming generation of total_samples rows, the table only holds one window of rows at a time.
+	// reduce_window(first_row) is called after every window, the table then holds the rows
+	// [first_row, first_row + GetNumberRows()) and their sample function results.
+	// The rows are the same as those of GenerateSamples with the same seed.
+	template<typename V, typename ReduceWindowTy>
+	void StreamSamples(const BatchSampler<V>& sampler, size_t total_samples, size_t sample_size, const EngineTypes engine_type, const std::uint64_t seed, JobControl* job_control, ReduceWindowTy reduce_window)
+	{
+		SetSize(std::min(total_samples, GetWindowRows(sample_size)), sample_size);
+		GenerateWindows(sampler, total_samples, engine_type, seed, job_control, reduce_window);
+	}
 
-		// Check std::execution::parallel_policy with algorithm
-		// Compare with 
-		// const auto t1 = std::chrono::high_resolution_clock::now();
-		// const auto t2 = std::chrono::high_resolution_clock::now();
-		// const std::chrono::duration<double, std::milli> ms = t2 - t1;
-
-		const size_t number_threads = 12;
+	// Appends rows to a table of GenerateSamples with the same sampler, engine type and seed
+	// until it holds number_samples rows. The rows are the same as those of a new generation,
+	// only the chunk holding the first new row is generated again.
+	template<typename V>
+	void AppendSamples(const BatchSampler<V>& sampler, size_t number_samples, const EngineTypes engine_type, const std::uint64_t seed, JobControl* job_control = nullptr)
+	{
+		const size_t kept_chunks = this->number_samples / GetRowsPerChunk();
 
-		const size_t rest = number_samples % number_threads;
-		const size_t slice_size = (number_samples - rest) / number_threads;
+		GrowRows(number_samples);
+		GenerateWindows(sampler, number_samples, engine_type, seed, job_control, [](const size_t) {}, kept_chunks);
+	}
 
-		std::vector<std::pair<std::size_t, std::size_t>> slice_indexes(number_threads);
+	// row i holds point i of the sequence,
+	// rows only depend on the sequence, the seed and the row index
+	template<typename V>
+	void GenerateQuasiRandomSamples(const QuasiRandomSampler<V>& sampler, size_t number_samples, size_t sample_size, JobControl* job_control = nullptr)
+	{
+		SetSize(number_samples, sample_size);
+		GenerateQuasiRandomWindows(sampler, number_samples, job_control, [](const size_t) {});
+	}
 
-		for (size_t index = 0; index < slice_indexes.size(); ++index)
-		{
-			if (index < slice_indexes.size() - 1)
-			{
-				slice_indexes[index].first = number_name_rows + slice_size * index;
-				slice_indexes[index].second = slice_indexes[index].first + slice_size;
-			}
-			else
-			{
-				slice_indexes[index].first = number_name_rows + slice_size * index;
-				slice_indexes[index].second = slice_indexes[index].first + slice_size + rest;
-			}
-		}
+	template<typename V>
+	void AppendQuasiRandomSamples(const QuasiRandomSampler<V>& sampler, size_t number_samples, JobControl* job_control = nullptr)
+	{
+		const size_t kept_chunks = this->number_samples / GetRowsPerChunk();
 
-		std::vector<std::thread> thread_array;
+		GrowRows(number_samples);
+		GenerateQuasiRandomWindows(sampler, number_samples, job_control, [](const size_t) {}, kept_chunks);
+	}
 
-		for (const auto& slice : slice_indexes)
-		{
-			std::thread current_thread(&DataTable::GenerateSamplesSubset<V>, this, random_distribution, slice.first, slice.second);
-			thread_array.push_back(std::move(current_thread));
-			//std::cout << "Started thread " << thread_array.size() << "\n";
+	// rows can be appended in place to a table on the heap
+	bool CanAppend(const size_t number_samples, const size_t sample_size) const
+	{
+		return !IsMapped() && storage_file.empty() && !result_columns.empty() && sample_size == this->sample_size && number_samples >= this->number_samples;
+	}
 
-			//GenerateSamplesSubset(random_distribution, slice.first, slice.second);
-		}
+	template<typename V, typename ReduceWindowTy>
+	void StreamQuasiRandomSamples(const QuasiRandomSampler<V>& sampler, size_t total_samples, size_t sample_size, JobControl* job_control, ReduceWindowTy reduce_window)
+	{
+		SetSize(std::min(total_samples, GetWindowRows(sample_size)), sample_size);
+		GenerateQuasiRandomWindows(sampler, total_samples, job_control, reduce_window);
+	}
 
-		for (size_t index = 0; index < thread_array.size(); ++index)
+	template<typename V>
+	void FillQuasiRandomSubset(QuasiRandomSampler<V> sampler, size_t row_begin_index, size_t row_end_index)
+	{
+		for (size_t row_index = row_begin_index; row_index < row_end_index; ++row_index)
 		{
-			thread_array[index].join();
-			//std::cout << "Joined thread " << index << "\n";
+			sampler.Fill(row_offset + row_index, GetSampleData(row_index), sample_size);
+			StoreSampleFunctionResults(row_index);
 		}
 	}
 
-	template<typename V>
-	void GenerateSamplesSubset(const V& random_distribution, size_t row_begin_index, size_t row_end_index)
+	// the rows are written in place
+	template<typename V, typename EngineTy>
+	void FillSamplesSubset(RandomNumberGenerator<V, EngineTy>&& generator, size_t row_begin_index, size_t row_end_index)
 	{
-		RandomNumberGenerator<V> generator(random_distribution);
-
 		for (size_t row_index = row_begin_index; row_index < row_end_index; ++row_index)
 		{
-			for (size_t col_index = 0; col_index < sample_size; ++col_index)
+			if constexpr (IsCounterBased<EngineTy>::value)
 			{
-				GetVariantRef(col_index, row_index) = generator.GenerateRandomNumber();
+				generator.SetStream(row_offset + row_index);
 			}
+
+			generator.GenerateRandomNumbers(GetSampleData(row_index), sample_size);
+			StoreSampleFunctionResults(row_index);
 		}
 	}
 
-	std::vector<std::string> GetSampleFunctionNames() const
+	// With a storage file the next generations write the table into the file, which is mapped into memory,
+	// so the number of rows is bounded by the disk instead of the memory.
+	// The file holds the sample matrix followed by one typed column per sample function.
+	// An empty path keeps the table on the heap.
+	void SetStorageFile(const std::filesystem::path& storage_file)
 	{
-		return sample_function_names;
+		this->storage_file = storage_file;
 	}
 
-	void CalculateSampleFunctionResults()
+	bool IsMapped() const
 	{
-		const size_t first_column = sample_size;
-		const size_t first_row = number_name_rows;
-
-		sample_function_names.resize(sample_function_results_columns);
-		sample_function_names[0] = std::string("sum");
-		sample_function_names[1] = std::string("mean");
-		sample_function_names[2] = std::string("tts");
-		sample_function_names[3] = std::string("variance1");
-		sample_function_names[4] = std::string("variance2");
+		return mapped_file.IsMapped();
+	}
 
-		
+	// empty before the first generation
+	const std::vector<std::string>& GetSampleFunctionNames() const
+	{
+		static const std::vector<std::string> no_sample_function_names;
+		return result_columns.empty() ? no_sample_function_names : sample_function_names;
+	}
 
-		for (size_t index = 0; index < sample_function_results_columns; ++index)
-		{
-			data[first_column + index] = sample_function_names[index];
-		}
+	// counts the generations, views into the table are valid while it stays the same
+	std::uint64_t GetGeneration() const
+	{
+		return generation;
+	}
 
-		const Ty1 double_sample_size = static_cast<Ty1>(sample_size);
+	// generation already stores the results of every row,
+	// this recalculates them from the samples in a separate pass
+	void CalculateSampleFunctionResults()
+	{
+		GetThreadPool().ParallelFor(GetNumberChunks(), [this](const size_t chunk_index)
+			{
+				const auto rows = GetChunkRows(chunk_index);
 
-		for (size_t index = 0; index < number_samples; ++index)
-		{
-			auto sample = GetSample(index);
-			auto sum = sample_functions.Sum(sample);
-			auto mean = sample_functions.Mean(sample);
-			auto tts = sample_functions.TotalSumOfSquares(sample, mean);
-
-			GetVariantRef(sample_size + 0, index + first_row) = sum;
-			GetVariantRef(sample_size + 1, index + first_row) = mean;
-			GetVariantRef(sample_size + 2, index + first_row) = tts;
-			GetVariantRef(sample_size + 3, index + first_row) = sample_functions.Variance(tts, double_sample_size);
-			GetVariantRef(sample_size + 4, index + first_row) = sample_functions.Variance(tts, double_sample_size - static_cast<Ty1>(1));
-		}
+				for (size_t row_index = rows.first; row_index < rows.second; ++row_index)
+				{
+					StoreSampleFunctionResults(row_index);
+				}
+			});
 	}
 
-	size_t GetColumnByName(const std::string& name) const
+	// moments of every sample column over all rows,
+	// the chunks are reduced column wise on the pool and merged in order
+	std::vector<CentralMoments> CalculateColumnMoments() const
 	{
-		size_t column = 0;
-		bool found = false;
+		std::vector<std::vector<CentralMoments>> chunk_moments(GetNumberChunks(), std::vector<CentralMoments>(sample_size, EmptyCentralMoments()));
 
-		for (size_t index = 0; index < number_columns; ++index)
+		GetThreadPool().ParallelFor(GetNumberChunks(), [this, &chunk_moments](const size_t chunk_index)
+			{
+				const auto rows = GetChunkRows(chunk_index);
+				ReduceColumns(GetSampleData(rows.first), rows.second - rows.first, sample_size, sample_size, chunk_moments[chunk_index].data());
+			});
+
+		std::vector<CentralMoments> column_moments(sample_size, EmptyCentralMoments());
+		for (const auto& moments : chunk_moments)
 		{
-			if (std::get<std::string>(data[index]) == name)
+			for (size_t column = 0; column < sample_size; ++column)
 			{
-				column = index;
-				found = true;
+				MergeMoments(column_moments[column], moments[column]);
 			}
 		}
 
-		found == false ? throw std::logic_error("data table: column name not found") : false;
+		return column_moments;
+	}
+
+	// sample columns come first, then the sample function results,
+	// the names are looked up in an index built when the columns are named
+	size_t GetColumnByName(const std::string& name) const
+	{
+		const auto found = column_index.find(name);
+
+		found == column_index.cend() ? throw std::logic_error("data table: column name not found") : false;
 
-		return column;
+		return found->second;
 	}
 
-	std::vector<Ty1> GetColumnData(const std::string& name) const
+	// views point into the table and are valid until the next generation
+
+	StridedView<const Ty1> GetColumnView(const std::string& name) const
 	{
-		size_t column = GetColumnByName(name);
+		const size_t column = GetColumnByName(name);
 
-		std::vector<Ty1> column_data(number_samples);
+		column < sample_size || result_columns.empty() ? throw std::logic_error("data table: column holds no sample function results") : false;
 
-		for (size_t index = 0; index < number_samples; ++index)
-		{
-			column_data[index] = std::get<Ty1>(GetVariantRef(column, index + number_name_rows));
-		}
+		return StridedView<const Ty1>(result_columns[column - sample_size], number_samples);
+	}
 
-		return column_data;
+	StridedView<const Ty0> GetSampleView(size_t number) const
+	{
+		return StridedView<const Ty0>(GetSampleData(number), sample_size);
 	}
 
-	std::vector<Ty0> GetSample(size_t number) const
+	// variable column of all samples, strided through the sample matrix
+	StridedView<const Ty0> GetSampleColumnView(size_t column) const
 	{
-		number += number_name_rows;
+		column >= sample_size ? throw std::logic_error("data table: column holds no sample variables") : false;
 
-		std::vector<Ty0> sample(sample_size);
+		return StridedView<const Ty0>(sample_values + column, number_samples, sample_size);
+	}
 
-		for (size_t index = 0; index < sample_size; ++index)
-		{
-			sample[index] = std::get<Ty0>(GetVariantRef(index, number));
-		}
+	std::vector<Ty1> GetColumnData(const std::string& name) const
+	{
+		return GetColumnView(name).ToVector();
+	}
+
+	std::vector<Ty0> GetSample(size_t number) const
+	{
+		return GetSampleView(number).ToVector();
+	}
 
-		return sample;
+	// sample_size contiguous values
+	Ty0* GetSampleData(size_t number)
+	{
+		return sample_values + number * sample_size;
 	}
 
-	VariantType& GetVariantRef(size_t column, size_t row)
+	const Ty0* GetSampleData(size_t number) const
 	{
-		return data[row * number_columns + column];
+		return sample_values + number * sample_size;
 	}
 
-	const VariantType& GetVariantRef(size_t column, size_t row) const
+	const std::vector<std::string>& GetColumnNames() const
 	{
-		return data[row * number_columns + column];
+		return column_names;
 	}
 
 	std::string GetString(size_t column, size_t row) const
 	{
 		std::stringstream stream;
 
-		auto variant = GetVariantRef(column, row);
-
-		std::visit([&stream](auto& variable)
-			{
-				stream << variable;
-			}, variant);
+		if (column < sample_size)
+		{
+			stream << GetSampleData(row)[column];
+		}
+		else
+		{
+			stream << result_columns[column - sample_size][row];
+		}
 
 		return stream.str();
 	}
 
 	size_t GetNumberRows() const
 	{
-		return number_rows;
+		return number_samples;
 	}
 
 	size_t GetNumberColumns() const
 	{
-		return number_columns;
+		return column_names.size();
 	}
 
 private:
 
+	// chunks of rows are the tasks of the thread pool and the unit of substreams,
+	// their size only depends on the sample size, so the rows of a seed stay the same
+	// for any number of threads and when rows are appended
+	static constexpr size_t chunk_bytes = size_t(1) << 18;
+
+	size_t GetRowsPerChunk() const
+	{
+		return GetRowsPerChunk(sample_size);
+	}
+
+	size_t GetNumberChunks() const
+	{
+		const size_t rows_per_chunk = GetRowsPerChunk();
+		return (number_samples + rows_per_chunk - 1) / rows_per_chunk;
+	}
+
+	std::pair<size_t, size_t> GetChunkRows(const size_t chunk_index) const
+	{
+		const size_t rows_per_chunk = GetRowsPerChunk();
+		return { chunk_index * rows_per_chunk, std::min(number_samples, (chunk_index + 1) * rows_per_chunk) };
+	}
+
+	// streaming windows are a whole number of chunks, a few per thread
+	static constexpr size_t chunks_per_thread_and_window = 4;
+
+	static size_t GetRowsPerChunk(const size_t sample_size)
+	{
+		return std::max<size_t>(1, chunk_bytes / std::max<size_t>(1, sample_size * sizeof(Ty0)));
+	}
+
+	static size_t GetWindowRows(const size_t sample_size)
+	{
+		return GetRowsPerChunk(sample_size) * chunks_per_thread_and_window * GetThreadPool().GetNumberThreads();
+	}
+
+	// the first kept_chunks chunks of the rows are left as they are
+	template<typename V, typename ReduceWindowTy>
+	void GenerateWindows(const BatchSampler<V>& sampler, const size_t total_samples, const EngineTypes engine_type, const std::uint64_t seed, JobControl* job_control, ReduceWindowTy reduce_window, const size_t kept_chunks = 0)
+	{
+		const auto no_preparation = [](const size_t) {};
+
+		switch (engine_type)
+		{
+		case xoshiro256ss:
+			GenerateSubstreamWindows<V, xoshiro256ss_Engine>(sampler, total_samples, seed, job_control, reduce_window, kept_chunks);
+			break;
+		case pcg64:
+			GenerateSubstreamWindows<V, pcg64_Engine>(sampler, total_samples, seed, job_control, reduce_window, kept_chunks);
+			break;
+		case splitmix64:
+			GenerateSubstreamWindows<V, splitmix64_Engine>(sampler, total_samples, seed, job_control, reduce_window, kept_chunks);
+			break;
+		case rdrand64_buffered:
+			GenerateChunkWindows(total_samples, job_control, reduce_window, kept_chunks, no_preparation, [&sampler](const size_t)
+				{
+					return RandomNumberGenerator<V, rdrand64_buffered_Engine>(sampler);
+				});
+			break;
+		case rdrand_prefilled:
+			GenerateChunkWindows(total_samples, job_control, reduce_window, kept_chunks, no_preparation, [&sampler](const size_t)
+				{
+					return RandomNumberGenerator<V, rdrand_prefilled_Engine>(sampler);
+				});
+			break;
+		case philox4x32:
+			GenerateChunkWindows(total_samples, job_control, reduce_window, kept_chunks, no_preparation, [&sampler, seed](const size_t)
+				{
+					return RandomNumberGenerator<V, philox4x32_Engine>(sampler, seed);
+				});
+			break;
+		case threefry2x64:
+			GenerateChunkWindows(total_samples, job_control, reduce_window, kept_chunks, no_preparation, [&sampler, seed](const size_t)
+				{
+					return RandomNumberGenerator<V, threefry2x64_Engine>(sampler, seed);
+				});
+			break;
+		default:
+			GenerateChunkWindows(total_samples, job_control, reduce_window, kept_chunks, no_preparation, [&sampler](const size_t)
+				{
+					return RandomNumberGenerator<V>(sampler);
+				});
+			break;
+		}
+	}
+
+	template<typename V, typename ReduceWindowTy>
+	void GenerateQuasiRandomWindows(const QuasiRandomSampler<V>& sampler, const size_t total_samples, JobControl* job_control, ReduceWindowTy reduce_window, const size_t kept_chunks = 0)
+	{
+		RunWindows(total_samples, job_control, kept_chunks, [](const size_t) {}, [this, &sampler](const size_t, const size_t row_begin_index, const size_t row_end_index)
+			{
+				FillQuasiRandomSubset(sampler, row_begin_index, row_end_index);
+			}, reduce_window);
+	}
+
+	// create_generator(chunk_index) returns the RandomNumberGenerator of a chunk of the window
+	template<typename ReduceWindowTy, typename PrepareWindowTy, typename CreateGeneratorTy>
+	void GenerateChunkWindows(const size_t total_samples, JobControl* job_control, ReduceWindowTy& reduce_window, const size_t kept_chunks, const PrepareWindowTy& prepare_window, CreateGeneratorTy create_generator)
+	{
+		RunWindows(total_samples, job_control, kept_chunks, prepare_window, [this, &create_generator](const size_t chunk_index, const size_t row_begin_index, const size_t row_end_index)
+			{
+				FillSamplesSubset(create_generator(chunk_index), row_begin_index, row_end_index);
+			}, reduce_window);
+	}
+
+	// the substreams are split off in order, one jump per chunk,
+	// the splitter carries on from one window to the next,
+	// the substream buffer keeps its capacity for the next generation on the same thread
+	template<typename V, typename EngineTy, typename ReduceWindowTy>
+	void GenerateSubstreamWindows(const BatchSampler<V>& sampler, const size_t total_samples, const std::uint64_t seed, JobControl* job_control, ReduceWindowTy& reduce_window, const size_t kept_chunks)
+	{
+		StreamSplitter<EngineTy> stream_splitter(seed);
+		std::vector<EngineTy>& substreams = GetSubstreamBuffer<EngineTy>();
+
+		const auto prepare_window = [&stream_splitter, &substreams](const size_t number_chunks)
+		{
+			substreams.clear();
+			for (size_t chunk_index = 0; chunk_index < number_chunks; ++chunk_index)
+			{
+				substreams.push_back(stream_splitter.Next());
+			}
+		};
+
+		GenerateChunkWindows(total_samples, job_control, reduce_window, kept_chunks, prepare_window, [&sampler, &substreams](const size_t chunk_index)
+			{
+				return RandomNumberGenerator<V, EngineTy>(sampler, substreams[chunk_index]);
+			});
+	}
+
+	// the pool threads reach the buffer of the generating thread through a reference
+	template<typename EngineTy>
+	static std::vector<EngineTy>& GetSubstreamBuffer()
+	{
+		static thread_local std::vector<EngineTy> substreams;
+		return substreams;
+	}
+
+	// The allocated rows are one window, windows are filled one after the other.
+	// prepare_window(number_chunks) runs before the chunks of a window,
+	// fill_chunk(chunk_index, row_begin_index, row_end_index) fills a chunk of the window,
+	// row_offset is the index of the first row of the window in the whole generation,
+	// the first kept_chunks chunks of the whole generation are not filled.
+	template<typename PrepareWindowTy, typename FillChunkTy, typename ReduceWindowTy>
+	void RunWindows(const size_t total_samples, JobControl* job_control, const size_t kept_chunks, const PrepareWindowTy& prepare_window, FillChunkTy fill_chunk, ReduceWindowTy& reduce_window)
+	{
+		const size_t window_rows = number_samples;
+		const size_t rows_per_chunk = GetRowsPerChunk();
+		const size_t total_chunks = (total_samples + rows_per_chunk - 1) / rows_per_chunk;
+
+		if (job_control != nullptr)
+		{
+			job_control->AddSteps(total_chunks - std::min(kept_chunks, total_chunks));
+		}
+
+		for (size_t first_row = 0; first_row < total_samples; first_row += window_rows)
+		{
+			if (job_control != nullptr && job_control->IsCancelled())
+			{
+				return;
+			}
+
+			number_samples = std::min(window_rows, total_samples - first_row);
+			row_offset = first_row;
+
+			prepare_window(GetNumberChunks());
+
+			const size_t window_first_chunk = first_row / rows_per_chunk;
+			const size_t first_chunk = kept_chunks > window_first_chunk ? std::min(kept_chunks - window_first_chunk, GetNumberChunks()) : 0;
+
+			RunChunks(job_control, first_chunk, [this, &fill_chunk](const size_t chunk_index)
+				{
+					const auto rows = GetChunkRows(chunk_index);
+					fill_chunk(chunk_index, rows.first, rows.second);
+				});
+
+			reduce_window(first_row);
+		}
+	}
+
+	// the chunks of the window from first_chunk on the pool, skipped once the job is cancelled
+	template<typename FunctionTy>
+	void RunChunks(JobControl* job_control, const size_t first_chunk, FunctionTy function)
+	{
+		GetThreadPool().ParallelFor(GetNumberChunks() - first_chunk, [job_control, first_chunk, &function](const size_t index)
+			{
+				if (job_control != nullptr && job_control->IsCancelled())
+				{
+					return;
+				}
+
+				function(first_chunk + index);
+
+				if (job_control != nullptr)
+				{
+					job_control->CompleteStep();
+				}
+			});
+	}
+
+	// the sample matrix is left uninitialized, generation overwrites every value
 	void SetSize(size_t number_samples, size_t sample_size)
 	{
 		this->number_samples = number_samples;
 		this->sample_size = sample_size;
+		row_offset = 0;
 
-		number_columns = sample_size + sample_function_results_columns;
-		number_rows = number_samples + number_name_rows;
+		if (storage_file.empty())
+		{
+			AllocateColumns();
+		}
+		else
+		{
+			MapColumns();
+		}
 
-		data.resize(number_columns * number_rows);
+		NameColumns();
 
-		NameSampleColumns();
+		++generation;
 	}
 
-	void NameSampleColumns()
+	// keeps the rows and their results, the views into the table are invalidated,
+	// the capacity grows by half so appending rows one by one moves the table rarely
+	void GrowRows(const size_t number_samples)
 	{
+		if (number_samples > row_capacity)
+		{
+			const size_t kept_rows = this->number_samples;
+			const Ty0* const kept_values = sample_values;
+			const std::vector<Ty1*> kept_columns = result_columns;
+			std::unique_ptr<std::byte[]> kept_storage = std::move(storage);
+
+			row_capacity = std::max(number_samples, row_capacity + row_capacity / 2);
+
+			const size_t samples_bytes = AlignTo(row_capacity * sample_size * sizeof(Ty0), heap_alignment);
+			const size_t column_bytes = AlignTo(row_capacity * sizeof(Ty1), heap_alignment);
+			storage_capacity = samples_bytes + sample_function_results_columns * column_bytes;
+			storage.reset(new std::byte[storage_capacity]);
+
+			PointIntoStorage(storage.get(), samples_bytes, column_bytes);
+
+			std::copy(kept_values, kept_values + kept_rows * sample_size, sample_values);
+			for (size_t index = 0; index < sample_function_results_columns; ++index)
+			{
+				std::copy(kept_columns[index], kept_columns[index] + kept_rows, result_columns[index]);
+			}
+		}
+
+		this->number_samples = number_samples;
+		row_offset = 0;
+
+		++generation;
+	}
+
+	// The heap holds the sample matrix and the result columns in one buffer, laid out like the storage file.
+	// The buffer grows and only shrinks when the table needs less than a quarter of it,
+	// so regenerations with the same or a similar shape do not allocate.
+	void AllocateColumns()
+	{
+		mapped_file.Unmap();
+
+		row_capacity = number_samples;
+
+		const size_t samples_bytes = AlignTo(number_samples * sample_size * sizeof(Ty0), heap_alignment);
+		const size_t column_bytes = AlignTo(number_samples * sizeof(Ty1), heap_alignment);
+		const size_t number_bytes = samples_bytes + sample_function_results_columns * column_bytes;
+
+		if (number_bytes > storage_capacity || number_bytes < storage_capacity / 4)
+		{
+			storage.reset();
+			storage.reset(new std::byte[number_bytes]);
+			storage_capacity = number_bytes;
+		}
+
+		PointIntoStorage(storage.get(), samples_bytes, column_bytes);
+	}
+
+	// The heap buffer is released, the table only occupies the pages the system keeps resident.
+	// The file is mapped again when its path or size changes.
+	void MapColumns()
+	{
+		storage.reset();
+		storage_capacity = 0;
+		row_capacity = number_samples;
+
+		const size_t samples_bytes = AlignTo(number_samples * sample_size * sizeof(Ty0), storage_alignment);
+		const size_t column_bytes = AlignTo(number_samples * sizeof(Ty1), storage_alignment);
+		const size_t number_bytes = samples_bytes + sample_function_results_columns * column_bytes;
+
+		if (!mapped_file.IsMapped() || mapped_file.GetPath() != storage_file || mapped_file.GetNumberBytes() != number_bytes)
+		{
+			mapped_file.Map(storage_file, number_bytes);
+		}
+
+		PointIntoStorage(static_cast<std::byte*>(mapped_file.GetAddress()), samples_bytes, column_bytes);
+	}
+
+	// heap regions are whole cache lines apart, the regions of the file start on their own page,
+	// 64 KiB is also the allocation granularity of windows
+	static constexpr size_t heap_alignment = 64;
+	static constexpr size_t storage_alignment = size_t(1) << 16;
+
+	static size_t AlignTo(const size_t number_bytes, const size_t alignment)
+	{
+		return (number_bytes + alignment - 1) / alignment * alignment;
+	}
+
+	// the sample matrix first, then one column per sample function
+	void PointIntoStorage(std::byte* const first, const size_t samples_bytes, const size_t column_bytes)
+	{
+		sample_values = reinterpret_cast<Ty0*>(first);
+		result_columns.resize(sample_function_results_columns);
+		for (size_t index = 0; index < sample_function_results_columns; ++index)
+		{
+			result_columns[index] = reinterpret_cast<Ty1*>(first + samples_bytes + index * column_bytes);
+		}
+	}
+
+	// called right after a row is generated, while it is still in cache
+	void StoreSampleFunctionResults(const size_t row_index)
+	{
+		const Ty1 double_sample_size = static_cast<Ty1>(sample_size);
+		const auto moments = sample_functions.CalculateMoments(GetSampleData(row_index), sample_size);
+
+		result_columns[0][row_index] = moments.sum;
+		result_columns[1][row_index] = moments.mean;
+		result_columns[2][row_index] = moments.totalsumofsquares;
+		result_columns[3][row_index] = sample_functions.Variance(moments.totalsumofsquares, double_sample_size);
+		result_columns[4][row_index] = sample_functions.Variance(moments.totalsumofsquares, double_sample_size - static_cast<Ty1>(1));
+		result_columns[5][row_index] = moments.min;
+		result_columns[6][row_index] = moments.max;
+		result_columns[7][row_index] = moments.skewness;
+		result_columns[8][row_index] = moments.kurtosis;
+	}
+
+	// the names only depend on the sample size
+	void NameColumns()
+	{
+		if (column_names.size() == sample_size + sample_function_results_columns)
+		{
+			return;
+		}
+
+		column_names.resize(sample_size + sample_function_results_columns);
+
 		for (size_t index = 0; index < sample_size; ++index)
 		{
-			GetVariantRef(index, 0) = std::to_string(index + 1);
+			column_names[index] = std::to_string(index + 1);
+		}
+		for (size_t index = 0; index < sample_function_results_columns; ++index)
+		{
+			column_names[sample_size + index] = sample_function_names[index];
+		}
+
+		column_index.clear();
+		for (size_t index = 0; index < column_names.size(); ++index)
+		{
+			column_index.emplace(column_names[index], index);
 		}
 	}
 
 	const size_t sample_function_results_columns;
-	const size_t number_name_rows;
 
 	size_t number_samples;
 	size_t sample_size;
 
-	size_t number_columns;
-	size_t number_rows;
+	// untyped, the matrix and the columns share it,
+	// the regions are laid out for row_capacity rows
+	std::unique_ptr<std::byte[]> storage;
+	size_t storage_capacity;
+	size_t row_capacity;
+
+	std::filesystem::path storage_file;
+	MappedFile mapped_file;
+
+	// point into the heap buffers or into the mapped file
+	Ty0* sample_values;
+	std::vector<Ty1*> result_columns;
+
+	size_t row_offset;
+	std::uint64_t generation;
+
+	std::vector<std::string> column_names;
+	std::unordered_map<std::string, size_t> column_index;
 
-	std::vector<VariantType> data;
 	SampleFunctions<Ty0, Ty1> sample_functions;
 	std::vector<std::string> sample_function_names;
 };
@@ -0,0 +1,331 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <type_traits>
+
+
+// portable unsigned 128 bit arithmetic,
+// only the operations needed by the engines below
+struct UInt128
+{
+	std::uint64_t high;
+	std::uint64_t low;
+};
+
+inline UInt128 Add(const UInt128& lhs, const UInt128& rhs)
+{
+	const std::uint64_t low = lhs.low + rhs.low;
+	const std::uint64_t carry = low < lhs.low ? 1 : 0;
+	return { lhs.high + rhs.high + carry, low };
+}
+
+inline UInt128 MultiplyFull(const std::uint64_t lhs, const std::uint64_t rhs)
+{
+	const std::uint64_t lhs_low = lhs & 0xFFFFFFFFull;
+	const std::uint64_t lhs_high = lhs >> 32;
+	const std::uint64_t rhs_low = rhs & 0xFFFFFFFFull;
+	const std::uint64_t rhs_high = rhs >> 32;
+
+	const std::uint64_t low_low = lhs_low * rhs_low;
+	const std::uint64_t high_low = lhs_high * rhs_low;
+	const std::uint64_t low_high = lhs_low * rhs_high;
+	const std::uint64_t high_high = lhs_high * rhs_high;
+
+	const std::uint64_t middle = (low_low >> 32) + (high_low & 0xFFFFFFFFull) + low_high;
+
+	return { high_high + (high_low >> 32) + (middle >> 32), (middle << 32) | (low_low & 0xFFFFFFFFull) };
+}
+
+inline UInt128 Multiply(const UInt128& lhs, const UInt128& rhs)
+{
+	UInt128 result = MultiplyFull(lhs.low, rhs.low);
+	result.high += lhs.high * rhs.low + lhs.low * rhs.high;
+	return result;
+}
+
+inline std::uint64_t RotateLeft(const std::uint64_t value, const unsigned int shift)
+{
+	return (value << (shift & 63)) | (value >> ((64 - shift) & 63));
+}
+
+inline std::uint64_t RotateRight(const std::uint64_t value, const unsigned int shift)
+{
+	return (value >> (shift & 63)) | (value << ((64 - shift) & 63));
+}
+
+
+// Vigna, SplitMix64,
+// used on its own and to expand seeds for the other engines
+class splitmix64_Engine
+{
+public:
+
+	using result_type = std::uint64_t;
+
+	explicit splitmix64_Engine(const result_type seed = 0) :
+		state(seed)
+	{}
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	result_type operator()()
+	{
+		state += 0x9E3779B97F4A7C15ull;
+
+		result_type random = state;
+		random = (random ^ (random >> 30)) * 0xBF58476D1CE4E5B9ull;
+		random = (random ^ (random >> 27)) * 0x94D049BB133111EBull;
+		return random ^ (random >> 31);
+	}
+
+	// same as delta calls
+	void Advance(const std::uint64_t delta)
+	{
+		state += delta * 0x9E3779B97F4A7C15ull;
+	}
+
+private:
+	result_type state;
+};
+
+
+// Blackman, Vigna, xoshiro256**
+class xoshiro256ss_Engine
+{
+public:
+
+	using result_type = std::uint64_t;
+
+	explicit xoshiro256ss_Engine(const result_type seed = 0)
+	{
+		splitmix64_Engine seed_sequence(seed);
+
+		for (auto& word : state)
+		{
+			word = seed_sequence();
+		}
+	}
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	result_type operator()()
+	{
+		const result_type random = RotateLeft(state[1] * 5, 7) * 9;
+		const result_type shifted = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+
+		state[2] ^= shifted;
+		state[3] = RotateLeft(state[3], 45);
+
+		return random;
+	}
+
+	// same as 2^128 calls
+	void Jump()
+	{
+		Jump({ 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull });
+	}
+
+	// same as 2^192 calls
+	void LongJump()
+	{
+		Jump({ 0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull });
+	}
+
+private:
+
+	// state after the number of calls given by the jump polynomial
+	void Jump(const std::array<std::uint64_t, 4>& polynomial)
+	{
+		std::array<result_type, 4> jumped = { 0, 0, 0, 0 };
+
+		for (const std::uint64_t word : polynomial)
+		{
+			for (unsigned int bit = 0; bit < 64; ++bit)
+			{
+				if (word & (std::uint64_t(1) << bit))
+				{
+					for (std::size_t index = 0; index < state.size(); ++index)
+					{
+						jumped[index] ^= state[index];
+					}
+				}
+				(*this)();
+			}
+		}
+
+		state = jumped;
+	}
+
+	std::array<result_type, 4> state;
+};
+
+
+// O'Neill, PCG64 (XSL RR 128/64),
+// stream selects one of 2^63 increments
+class pcg64_Engine
+{
+public:
+
+	using result_type = std::uint64_t;
+
+	explicit pcg64_Engine(const result_type seed = 0, const result_type stream = 0) :
+		state({ 0, 0 }),
+		increment({ default_increment.high, default_increment.low ^ (stream << 1) })
+	{
+		Step();
+		state = Add(state, { 0, seed });
+		Step();
+	}
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	result_type operator()()
+	{
+		Step();
+		return RotateRight(state.high ^ state.low, static_cast<unsigned int>(state.high >> 58));
+	}
+
+	// Brown, Random Number Generation with Arbitrary Strides,
+	// same as delta calls in O(log delta)
+	void Advance(const UInt128& delta)
+	{
+		UInt128 accumulated_multiplier = { 0, 1 };
+		UInt128 accumulated_increment = { 0, 0 };
+		UInt128 current_multiplier = multiplier;
+		UInt128 current_increment = increment;
+
+		for (unsigned int bit = 0; bit < 128; ++bit)
+		{
+			const std::uint64_t word = bit < 64 ? delta.low : delta.high;
+			if (word & (std::uint64_t(1) << (bit & 63)))
+			{
+				accumulated_multiplier = Multiply(accumulated_multiplier, current_multiplier);
+				accumulated_increment = Add(Multiply(accumulated_increment, current_multiplier), current_increment);
+			}
+			current_increment = Multiply(Add(current_multiplier, { 0, 1 }), current_increment);
+			current_multiplier = Multiply(current_multiplier, current_multiplier);
+		}
+
+		state = Add(Multiply(accumulated_multiplier, state), accumulated_increment);
+	}
+
+private:
+
+	void Step()
+	{
+		state = Add(Multiply(state, multiplier), increment);
+	}
+
+	static constexpr UInt128 multiplier = { 0x2360ED051FC65DA4ull, 0x4385DF649FCCF645ull };
+	static constexpr UInt128 default_increment = { 0x5851F42D4C957F2Dull, 0x14057B7EF767814Full };
+
+	UInt128 state;
+	UInt128 increment;
+};
+
+
+// Substreams of one master seed for parallel workers,
+// substream i starts i jumps after the seeded engine:
+// xoshiro256** 2^128 values apart, pcg64 2^64, splitmix64 2^48,
+// no worker can draw enough values to reach the next substream
+template<typename EngineTy>
+class StreamSplitter
+{
+public:
+
+	explicit StreamSplitter(const std::uint64_t seed) :
+		engine(seed)
+	{}
+
+	// substreams in order, one jump per call
+	EngineTy Next()
+	{
+		EngineTy substream = engine;
+		JumpSubstreams(engine, 1);
+		return substream;
+	}
+
+	// random access for workers creating their own engine
+	static EngineTy GetSubstream(const std::uint64_t seed, const std::uint64_t substream)
+	{
+		EngineTy engine(seed);
+		JumpSubstreams(engine, substream);
+		return engine;
+	}
+
+private:
+
+	static void JumpSubstreams(EngineTy& engine, const std::uint64_t number_substreams)
+	{
+		if constexpr (std::is_same<EngineTy, xoshiro256ss_Engine>::value)
+		{
+			for (std::uint64_t index = 0; index < number_substreams; ++index)
+			{
+				engine.Jump();
+			}
+		}
+		else if constexpr (std::is_same<EngineTy, pcg64_Engine>::value)
+		{
+			engine.Advance({ number_substreams, 0 });
+		}
+		else
+		{
+			static_assert(std::is_same<EngineTy, splitmix64_Engine>::value, "engine without jump ahead");
+			engine.Advance(number_substreams << 48);
+		}
+	}
+
+	EngineTy engine;
+};
@@ -21,16 +21,113 @@ See <https://www.gnu.org/licenses/gpl-2.0.txt>.
 
 #pragma once
 
+#include "cpu_dispatch.h"
+#include "random_engines.h"
+#include "counter_engines.h"
+#include "batch_samplers.h"
+#include "spsc_ring_buffer.h"
+
 #include <vector>
 #include <random>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <immintrin.h>
 
 
+enum EngineTypes
+{
+	rdrand32,
+	xoshiro256ss,
+	pcg64,
+	splitmix64,
+	rdrand64_buffered,
+	philox4x32,
+	threefry2x64,
+	rdrand_prefilled
+};
+
+inline std::array<std::string, 8> GetEngineNames()
+{
+	return { "rdrand32", "xoshiro256**", "pcg64", "splitmix64", "rdrand64 buffered", "philox4x32-10", "threefry2x64-20", "rdrand prefilled" };
+}
+
+// without rdrand the rdrand engines only forward their software fallback
+inline EngineTypes GetDefaultEngineType()
+{
+	return GetCpuFeatures().rdrand ? rdrand_prefilled : xoshiro256ss;
+}
+
+
+// Intel recommends 10 retries before the
+// hardware random number generator is considered failed,
+// a cleared carry flag signals an underflow of the entropy source
+constexpr int rdrand_retry_limit = 10;
+
+// compiled for rdrand regardless of the compiler options,
+// only called after GetCpuFeatures reported the instruction
+SIMD_TARGET("rdrnd")
+inline bool RdrandStep(unsigned int& random)
+{
+	for (int retry = 0; retry < rdrand_retry_limit; ++retry)
+	{
+		if (_rdrand32_step(&random))
+		{
+			return true;
+		}
+		_mm_pause();
+	}
+	return false;
+}
+
+SIMD_TARGET("rdrnd")
+inline bool RdrandStep(unsigned long long& random)
+{
+	for (int retry = 0; retry < rdrand_retry_limit; ++retry)
+	{
+		if (_rdrand64_step(&random))
+		{
+			return true;
+		}
+		_mm_pause();
+	}
+	return false;
+}
+
+
+// software engine for exhausted rdrand retries,
+// seeded on first use only
+class RdrandFallback
+{
+public:
+
+	std::uint64_t operator()()
+	{
+		if (!engine.has_value())
+		{
+			std::random_device seed_device;
+			engine.emplace((static_cast<std::uint64_t>(seed_device()) << 32) | seed_device());
+		}
+		return (*engine)();
+	}
+
+private:
+	std::optional<xoshiro256ss_Engine> engine;
+};
+
+
 class rdrand32_Engine
 {
 public:
 
-	rdrand32_Engine()
+	rdrand32_Engine() :
+		rdrand_available(GetCpuFeatures().rdrand)
 	{}
 
 	using result_type = unsigned int;
@@ -45,20 +142,338 @@ public:
 		return static_cast<result_type>(-1);
 	}
 
-	//use -mrdrnd compiler option for g++
 	result_type operator()() 
 	{
 		result_type random;
-		_rdrand32_step(&random);
+		if (!rdrand_available || !RdrandStep(random))
+		{
+			random = static_cast<result_type>(fallback());
+		}
 		return random;
 	}
 
 	rdrand32_Engine(const rdrand32_Engine&) = delete;
 	rdrand32_Engine& operator=(const rdrand32_Engine&) = delete;
+
+private:
+	bool rdrand_available;
+	RdrandFallback fallback;
 };
 
 
-template<typename T>
+// fills a block of 64 bit rdrand values at once
+// and serves them as two 32 bit values each,
+// every generator thread owns its own block
+class rdrand64_buffered_Engine
+{
+public:
+
+	rdrand64_buffered_Engine() :
+		position(number_values),
+		rdrand_available(GetCpuFeatures().rdrand)
+	{}
+
+	using result_type = unsigned int;
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	result_type operator()()
+	{
+		if (position == number_values)
+		{
+			Refill();
+		}
+
+		const unsigned long long word = block[position >> 1];
+		const result_type random = static_cast<result_type>((position & 1) ? (word >> 32) : word);
+		++position;
+
+		return random;
+	}
+
+	rdrand64_buffered_Engine(const rdrand64_buffered_Engine&) = delete;
+	rdrand64_buffered_Engine& operator=(const rdrand64_buffered_Engine&) = delete;
+
+private:
+
+	void Refill()
+	{
+		for (auto& word : block)
+		{
+			if (!rdrand_available || !RdrandStep(word))
+			{
+				word = fallback();
+			}
+		}
+		position = 0;
+	}
+
+	static constexpr size_t block_size = 256;
+	static constexpr size_t number_values = 2 * block_size;
+
+	alignas(64) std::array<unsigned long long, block_size> block;
+	size_t position;
+	bool rdrand_available;
+	RdrandFallback fallback;
+};
+
+
+// Background thread keeping one ring buffer of rdrand words per consumer filled,
+// generator threads take their words from the buffer
+// instead of waiting for the hardware on every refill.
+// Buffers stay filled between generations, a released buffer
+// is handed to the next consumer with its remaining words.
+class EntropyService
+{
+public:
+
+	static constexpr size_t max_number_consumers = 16;
+	static constexpr size_t buffer_capacity = size_t(1) << 14;
+
+	EntropyService() :
+		rdrand_available(GetCpuFeatures().rdrand),
+		refill_requested(false),
+		stop(false)
+	{
+		for (auto& slot : slots)
+		{
+			slot.buffer = std::make_unique<SpscRingBuffer<unsigned long long>>(buffer_capacity);
+			slot.in_use.store(false);
+			slot.active.store(false);
+		}
+
+		producer_thread = std::thread(&EntropyService::Produce, this);
+	}
+
+	~EntropyService()
+	{
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+			stop.store(true, std::memory_order_release);
+		}
+		wake_condition.notify_one();
+		producer_thread.join();
+	}
+
+	EntropyService(const EntropyService&) = delete;
+	EntropyService& operator=(const EntropyService&) = delete;
+
+	// nullptr if all buffers are taken
+	SpscRingBuffer<unsigned long long>* AcquireBuffer()
+	{
+		for (auto& slot : slots)
+		{
+			bool expected = false;
+			if (slot.in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+			{
+				if (!slot.active.exchange(true, std::memory_order_acq_rel))
+				{
+					RequestRefill();
+				}
+				return slot.buffer.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void ReleaseBuffer(SpscRingBuffer<unsigned long long>* buffer)
+	{
+		for (auto& slot : slots)
+		{
+			if (slot.buffer.get() == buffer)
+			{
+				slot.in_use.store(false, std::memory_order_release);
+				RequestRefill();
+				return;
+			}
+		}
+	}
+
+	// called by consumers whose buffer is running low
+	void RequestRefill()
+	{
+		if (!refill_requested.exchange(true, std::memory_order_acq_rel))
+		{
+			{
+				std::lock_guard<std::mutex> lock(wake_mutex);
+			}
+			wake_condition.notify_one();
+		}
+	}
+
+private:
+
+	struct Slot
+	{
+		std::unique_ptr<SpscRingBuffer<unsigned long long>> buffer;
+		std::atomic<bool> in_use;
+		std::atomic<bool> active;
+	};
+
+	void Produce()
+	{
+		alignas(64) std::array<unsigned long long, 256> block;
+
+		for (;;)
+		{
+			refill_requested.store(false, std::memory_order_release);
+
+			for (auto& slot : slots)
+			{
+				if (!slot.active.load(std::memory_order_acquire))
+				{
+					continue;
+				}
+
+				while (slot.buffer->GetCapacity() - slot.buffer->GetSize() >= block.size())
+				{
+					for (auto& word : block)
+					{
+						if (!rdrand_available || !RdrandStep(word))
+						{
+							word = fallback();
+						}
+					}
+					slot.buffer->Push(block.data(), block.size());
+
+					if (stop.load(std::memory_order_acquire))
+					{
+						return;
+					}
+				}
+			}
+
+			std::unique_lock<std::mutex> lock(wake_mutex);
+			wake_condition.wait(lock, [this]()
+				{
+					return stop.load(std::memory_order_acquire) || refill_requested.load(std::memory_order_acquire);
+				});
+			if (stop.load(std::memory_order_acquire))
+			{
+				return;
+			}
+		}
+	}
+
+	bool rdrand_available;
+	std::array<Slot, max_number_consumers> slots;
+	RdrandFallback fallback;
+
+	std::atomic<bool> refill_requested;
+	std::atomic<bool> stop;
+	std::mutex wake_mutex;
+	std::condition_variable wake_condition;
+	std::thread producer_thread;
+};
+
+// started with the first prefilled engine, stopped at program exit
+inline EntropyService& GetEntropyService()
+{
+	static EntropyService entropy_service;
+	return entropy_service;
+}
+
+
+// rdrand words from a buffer of the EntropyService,
+// served as two 32 bit values each like rdrand64_buffered_Engine,
+// words missing in the buffer are drawn directly
+class rdrand_prefilled_Engine
+{
+public:
+
+	rdrand_prefilled_Engine() :
+		entropy_service(GetEntropyService()),
+		buffer(entropy_service.AcquireBuffer()),
+		position(number_values),
+		rdrand_available(GetCpuFeatures().rdrand)
+	{}
+
+	~rdrand_prefilled_Engine()
+	{
+		if (buffer)
+		{
+			entropy_service.ReleaseBuffer(buffer);
+		}
+	}
+
+	using result_type = unsigned int;
+
+	static constexpr result_type(min)()
+	{
+		return 0;
+	}
+
+	static constexpr result_type(max)()
+	{
+		return static_cast<result_type>(-1);
+	}
+
+	result_type operator()()
+	{
+		if (position == number_values)
+		{
+			Refill();
+		}
+
+		const unsigned long long word = block[position >> 1];
+		const result_type random = static_cast<result_type>((position & 1) ? (word >> 32) : word);
+		++position;
+
+		return random;
+	}
+
+	rdrand_prefilled_Engine(const rdrand_prefilled_Engine&) = delete;
+	rdrand_prefilled_Engine& operator=(const rdrand_prefilled_Engine&) = delete;
+
+private:
+
+	void Refill()
+	{
+		size_t index = 0;
+
+		if (buffer)
+		{
+			index = buffer->Pop(block.data(), block.size());
+
+			if (buffer->GetSize() < buffer->GetCapacity() / 2)
+			{
+				entropy_service.RequestRefill();
+			}
+		}
+
+		for (; index < block.size(); ++index)
+		{
+			if (!rdrand_available || !RdrandStep(block[index]))
+			{
+				block[index] = fallback();
+			}
+		}
+		position = 0;
+	}
+
+	static constexpr size_t block_size = 256;
+	static constexpr size_t number_values = 2 * block_size;
+
+	EntropyService& entropy_service;
+	SpscRingBuffer<unsigned long long>* buffer;
+	alignas(64) std::array<unsigned long long, block_size> block;
+	size_t position;
+	bool rdrand_available;
+	RdrandFallback fallback;
+};
+
+
+// T random distribution,
+// EngineTy uniform random bit generator
+template<typename T, typename EngineTy = rdrand32_Engine>
 class RandomNumberGenerator
 {
 public:
@@ -66,16 +481,50 @@ public:
 	using U = typename T::result_type;
 	
 	RandomNumberGenerator(const T& distribution) :
-		distribution(distribution) 
+		sampler(distribution) 
+	{}
+
+	RandomNumberGenerator(const BatchSampler<T>& sampler) :
+		sampler(sampler)
+	{}
+
+	// only for seedable engines
+	RandomNumberGenerator(const T& distribution, const std::uint64_t seed) :
+		engine(seed),
+		sampler(distribution)
+	{}
+
+	RandomNumberGenerator(const BatchSampler<T>& sampler, const std::uint64_t seed) :
+		engine(seed),
+		sampler(sampler)
+	{}
+
+	// only for copyable engines, e.g. a substream of StreamSplitter
+	RandomNumberGenerator(const BatchSampler<T>& sampler, const EngineTy& engine) :
+		engine(engine),
+		sampler(sampler)
 	{}
 
 	U GenerateRandomNumber()
 	{
-		return distribution(rdrand);
+		return sampler.Sample(engine);
+	}
+
+	void GenerateRandomNumbers(U* values, const size_t count)
+	{
+		sampler.Fill(engine, values, count);
+	}
+
+	// only for counter based engines,
+	// restarts at the first value of the stream
+	// and drops values cached by the distribution
+	void SetStream(const std::uint64_t stream)
+	{
+		engine.Seek(stream, 0);
+		sampler.Reset();
 	}
 
 private:
-	rdrand32_Engine rdrand;
-	T distribution;
+	EngineTy engine;
+	BatchSampler<T> sampler;
 };
-
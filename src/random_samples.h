@@ -24,6 +24,12 @@ See <https://www.gnu.org/licenses/gpl-2.0.txt>.
 #include "file_io.h"
 #include "random_numbers.h"
 #include "random_data_table.h"
+#include "sample_stream.h"
+
+#include <boost/math/distributions/beta.hpp>
+#include <boost/math/distributions/laplace.hpp>
+#include <boost/math/distributions/logistic.hpp>
+#include <boost/math/distributions/rayleigh.hpp>
 
 #include <array>
 #include <vector>
@@ -37,6 +43,7 @@ See <https://www.gnu.org/licenses/gpl-2.0.txt>.
 #include <type_traits>
 #include <algorithm>
 #include <thread>
+#include <mutex>
 #include <utility>
 #include <exception>
 #include <typeinfo>
@@ -47,6 +54,7 @@ See <https://www.gnu.org/licenses/gpl-2.0.txt>.
 #include <tuple>
 #include <optional>
 #include <limits>
+#include <filesystem>
 
 
 
@@ -95,12 +103,12 @@ public:
 		return parameter_types;
 	}
 
-	std::string GetName()
+	const std::string& GetName() const
 	{
 		return distribution_name;
 	}
 
-	std::vector<std::string> GetParameterNames()
+	const std::vector<std::string>& GetParameterNames() const
 	{
 		return parameter_names;
 	}
@@ -123,11 +131,49 @@ public:
 
 	virtual void SetSamplerConfig(const size_t number_samples, const size_t sample_size) = 0;
 	virtual std::array<size_t, 2> GetSamplerConfig() const = 0;
+	virtual void SetEngineType(const EngineTypes engine_type) = 0;
+	virtual EngineTypes GetEngineType() const = 0;
+	virtual void SetSeed(const std::optional<std::uint64_t> seed) = 0;
+	virtual std::uint64_t GetLastSeed() const = 0;
+	virtual void SetTruncationEpsilon(const double epsilon) = 0;
+	virtual void SetSamplingMode(const SamplingModes sampling_mode) = 0;
+	virtual SamplingModes GetSamplingMode() const = 0;
 	virtual void GenerateSamples() = 0;
 
+	// generation into a back buffer on a background thread,
+	// a new call cancels a stale generation that is still running,
+	// SwapResults publishes a finished generation and has to be called by the reading thread
+	virtual void GenerateSamplesAsync() = 0;
+	virtual bool SwapResults() = 0;
+	virtual bool IsGenerating() const = 0;
+	virtual float GetGenerationProgress() const = 0;
+
+	// the message of the latest generation if it failed, its back buffer is not published then,
+	// cleared by the next GenerateSamplesAsync
+	virtual std::optional<std::string> GetGenerationError() const = 0;
+
 	virtual std::any GetSample(const size_t index) const = 0;
-	virtual std::vector<std::string> GetSampleFunctionNames() const = 0;
+	virtual const std::vector<std::string>& GetSampleFunctionNames() const = 0;
 	virtual std::any GetSampleFunctionResults(const std::string& name) const = 0;
+
+	// StridedView<const result_type> and StridedView<const RationalTy> into the data table,
+	// valid until the generation changes
+	virtual std::any GetSampleView(const size_t index) const = 0;
+	virtual std::any GetSampleFunctionResultsView(const std::string& name) const = 0;
+
+	// changes with every published generation, views and results derived from them
+	// only have to be refreshed when it changes
+	virtual std::uint64_t GetGeneration() const = 0;
+
+	// a streaming generation keeps the moments and histograms of the sample functions over all rows,
+	// the table only holds the last window of rows then
+	virtual void SetStreaming(const StreamingConfig& streaming_config) = 0;
+	virtual bool IsStreaming() const = 0;
+	virtual const SampleFunctionStream& GetSampleFunctionStream() const = 0;
+
+	// with a directory the tables are memory mapped files in it, bounded by the disk instead of the memory,
+	// without one they stay on the heap
+	virtual void SetStorageDirectory(const std::optional<std::filesystem::path>& storage_directory) = 0;
 };
 
 
@@ -140,7 +186,15 @@ public:
 
 	SamplingManager(const std::string& distribution_name, const ParameterTypes parameter_types, const std::vector<std::string>& parameter_names) :
 		SamplingManagerInterface(distribution_name, parameter_types, parameter_names),
-		sampler_config({1000, 30})
+		sampler_config({1000, 30}),
+		engine_type(GetDefaultEngineType()),
+		sampling_mode(pseudo_random),
+		last_seed(0),
+		truncation_epsilon(AliasTableCache::default_epsilon),
+		streaming_config({false, 20, 0.f, 1.f}),
+		front_index(0),
+		back_ready(false),
+		generation(0)
 	{
 		UpdateParameterPackage(true);
 	}
@@ -162,47 +216,404 @@ public:
 		return sampler_config;
 	}
 
+	virtual void SetEngineType(const EngineTypes engine_type) override
+	{
+		this->engine_type = engine_type;
+	}
+
+	virtual EngineTypes GetEngineType() const override
+	{
+		return engine_type;
+	}
+
+	// without a seed every generation draws a new one,
+	// GetLastSeed allows to replay a generation
+	virtual void SetSeed(const std::optional<std::uint64_t> seed) override
+	{
+		this->seed = seed;
+	}
+
+	virtual std::uint64_t GetLastSeed() const override
+	{
+		return last_seed;
+	}
+
+	// tail mass dropped from alias tables of discrete distributions,
+	// takes effect with the next generation
+	virtual void SetTruncationEpsilon(const double epsilon) override
+	{
+		truncation_epsilon = epsilon;
+	}
+
+	// quasi random rows map sobol or halton points through the quantile function,
+	// the seed randomizes the scrambling
+	virtual void SetSamplingMode(const SamplingModes sampling_mode) override
+	{
+		this->sampling_mode = sampling_mode;
+	}
+
+	virtual SamplingModes GetSamplingMode() const override
+	{
+		return sampling_mode;
+	}
+
+	// blocks until the generation is published
 	void GenerateSamples() override
 	{
-		random_distribution.reset();
+		GenerateSamplesAsync();
+		generation_runner.Wait();
+		SwapResults();
+	}
+
+	// The configuration is copied into the job, it may change while the job runs.
+	// Only the parameters are copied, the job applies them to its distribution,
+	// so tables of tabulated distributions are built off the calling thread.
+	// When only the number of samples grew the generation goes on with the seed of the published one,
+	// the job then appends the new rows to the back table if it holds a smaller generation of the same kind.
+	virtual void GenerateSamplesAsync() override
+	{
 		UpdateParameterPackage();
 
-		data_table.GenerateSamples(random_distribution, sampler_config[0], sampler_config[1]);
-		data_table.CalculateSampleFunctionResults();
+		std::optional<GenerationKey> front_key;
+		{
+			std::lock_guard<std::mutex> lock(results_mutex);
+			front_key = table_keys[front_index];
+		}
+
+		if (seed.has_value())
+		{
+			last_seed = seed.value();
+		}
+		else if (front_key.has_value() && sampler_config[0] > front_key->number_samples && IsAppendable(front_key.value(), MakeGenerationKey(front_key->seed)))
+		{
+			last_seed = front_key->seed;
+		}
+		else
+		{
+			std::random_device seed_device;
+			last_seed = (static_cast<std::uint64_t>(seed_device()) << 32) | seed_device();
+		}
+
+		generation_runner.Submit([this, key = MakeGenerationKey(last_seed), streaming_config = streaming_config, storage_directory = storage_directory](JobControl& job_control)
+			{
+				size_t back_index;
+				std::optional<GenerationKey> back_key;
+				{
+					std::lock_guard<std::mutex> lock(results_mutex);
+					back_index = 1 - front_index;
+					back_ready = false;
+					back_key = table_keys[back_index];
+					table_keys[back_index].reset();
+				}
+
+				// unchanged parameters keep the table of a tabulated distribution
+				job_distribution.param(key.parameters);
+				job_distribution.reset();
+
+				auto& data_table = data_tables[back_index];
+				data_table.SetStorageFile(storage_directory.has_value() ? GetStorageFile(storage_directory.value(), back_index) : std::filesystem::path());
+
+				const bool append = !streaming_config.enabled && back_key.has_value() && IsAppendable(back_key.value(), key) && data_table.CanAppend(key.number_samples, key.sample_size);
+
+				FillTable(data_table, streams[back_index], job_distribution, key, streaming_config, append, job_control);
+
+				if (!job_control.IsCancelled())
+				{
+					std::lock_guard<std::mutex> lock(results_mutex);
+					back_ready = true;
+
+					// a streamed table only holds its last window
+					if (!streaming_config.enabled)
+					{
+						table_keys[back_index] = key;
+					}
+				}
+			});
+	}
+
+	virtual bool SwapResults() override
+	{
+		std::lock_guard<std::mutex> lock(results_mutex);
+
+		if (!back_ready)
+		{
+			return false;
+		}
+
+		front_index = 1 - front_index;
+		back_ready = false;
+		++generation;
+		return true;
+	}
+
+	virtual bool IsGenerating() const override
+	{
+		return generation_runner.IsBusy();
+	}
+
+	virtual float GetGenerationProgress() const override
+	{
+		return generation_runner.GetProgress();
+	}
+
+	virtual std::optional<std::string> GetGenerationError() const override
+	{
+		const std::exception_ptr exception = generation_runner.GetException();
+		if (!exception)
+		{
+			return std::nullopt;
+		}
+
+		try
+		{
+			std::rethrow_exception(exception);
+		}
+		catch (const std::exception& error)
+		{
+			return std::string(error.what());
+		}
+		catch (...)
+		{
+			return std::string("unknown error");
+		}
 	}
 
 	virtual std::any GetSample(const size_t index) const override
 	{
-		return data_table.GetSample(index);
+		return data_tables[front_index].GetSample(index);
 	}
 
-	virtual std::vector<std::string> GetSampleFunctionNames() const override
+	virtual const std::vector<std::string>& GetSampleFunctionNames() const override
 	{
-		return data_table.GetSampleFunctionNames();
+		return data_tables[front_index].GetSampleFunctionNames();
 	}
 
 	virtual std::any GetSampleFunctionResults(const std::string& name) const override
 	{
-		return data_table.GetColumnData(name);
+		return data_tables[front_index].GetColumnData(name);
+	}
+
+	virtual std::any GetSampleView(const size_t index) const override
+	{
+		return data_tables[front_index].GetSampleView(index);
+	}
+
+	virtual std::any GetSampleFunctionResultsView(const std::string& name) const override
+	{
+		return data_tables[front_index].GetColumnView(name);
+	}
+
+	virtual std::uint64_t GetGeneration() const override
+	{
+		return generation;
+	}
+
+	// the histogram limits are fixed when the generation starts
+	virtual void SetStreaming(const StreamingConfig& streaming_config) override
+	{
+		this->streaming_config = streaming_config;
+	}
+
+	virtual bool IsStreaming() const override
+	{
+		return streams[front_index].IsActive();
+	}
+
+	virtual const SampleFunctionStream& GetSampleFunctionStream() const override
+	{
+		return streams[front_index];
+	}
+
+	// takes effect with the next generation
+	virtual void SetStorageDirectory(const std::optional<std::filesystem::path>& storage_directory) override
+	{
+		this->storage_directory = storage_directory;
 	}
 
 	void WriteToFile(FileOutput& file_output) const
 	{
-		for (size_t row_index = 0; row_index < data_table.GetNumberRows(); ++row_index)
+		const auto& data_table = data_tables[front_index];
+
+		for (const auto& column_name : data_table.GetColumnNames())
+		{
+			file_output << column_name << '\t';
+		}
+		file_output << '\n';
+
+		// blocks of rows are formatted by the thread pool and written in order,
+		// a bounded number of blocks is held in memory at a time
+		const size_t rows_per_block = 1024;
+		const size_t number_rows = data_table.GetNumberRows();
+		const size_t number_blocks = (number_rows + rows_per_block - 1) / rows_per_block;
+		const size_t blocks_per_batch = 4 * GetThreadPool().GetNumberThreads();
+
+		std::vector<std::string> formatted_blocks(std::min(number_blocks, blocks_per_batch));
+
+		for (size_t batch_begin = 0; batch_begin < number_blocks; batch_begin += blocks_per_batch)
 		{
-			for (size_t col_index = 0; col_index < data_table.GetNumberColumns(); ++col_index)
+			const size_t batch_size = std::min(blocks_per_batch, number_blocks - batch_begin);
+
+			GetThreadPool().ParallelFor(batch_size, [&data_table, &formatted_blocks, batch_begin, rows_per_block, number_rows](const size_t batch_index)
+				{
+					const size_t row_begin = (batch_begin + batch_index) * rows_per_block;
+					const size_t row_end = std::min(number_rows, row_begin + rows_per_block);
+
+					std::string& formatted_block = formatted_blocks[batch_index];
+					formatted_block.clear();
+
+					for (size_t row_index = row_begin; row_index < row_end; ++row_index)
+					{
+						for (size_t col_index = 0; col_index < data_table.GetNumberColumns(); ++col_index)
+						{
+							formatted_block += data_table.GetString(col_index, row_index);
+							formatted_block += '\t';
+						}
+						formatted_block += '\n';
+					}
+				});
+
+			for (size_t batch_index = 0; batch_index < batch_size; ++batch_index)
 			{
-				file_output << data_table.GetString(col_index, row_index) << '\t';
+				file_output << formatted_blocks[batch_index];
 			}
-			file_output << '\n';
 		}
 	}
 
 private:
 
-	DistributionTy random_distribution;
+	ParametersTy distribution_parameters;
 	std::array<size_t, 2> sampler_config;
-	DataTable<ResultTy, RationalTy> data_table;
+	EngineTypes engine_type;
+	SamplingModes sampling_mode;
+	std::optional<std::uint64_t> seed;
+	std::uint64_t last_seed;
+	double truncation_epsilon;
+	StreamingConfig streaming_config;
+	std::optional<std::filesystem::path> storage_directory;
+
+	// the reading thread sees data_tables[front_index] and streams[front_index],
+	// the job writes the other pair, back_ready is set when it is complete
+	std::array<DataTable<ResultTy, RationalTy>, 2> data_tables;
+	std::array<SampleFunctionStream, 2> streams;
+
+	// what the rows of a table were generated from
+	struct GenerationKey
+	{
+		ParametersTy parameters;
+		size_t number_samples;
+		size_t sample_size;
+		EngineTypes engine_type;
+		SamplingModes sampling_mode;
+		std::uint64_t seed;
+		double truncation_epsilon;
+	};
+
+	// empty while a table is written or when it holds no complete generation
+	std::array<std::optional<GenerationKey>, 2> table_keys;
+	size_t front_index;
+	bool back_ready;
+	std::uint64_t generation;
+	std::mutex results_mutex;
+
+	// only touched by the job, with the parameters and the epsilon of the generation key
+	DistributionTy job_distribution;
+	AliasTableCache alias_table_cache;
+
+	// destroyed first, joins the job before the tables go away
+	LatestJobRunner generation_runner;
+
+	// one file per process, distribution and table, both tables of a distribution are mapped at the same time
+	std::filesystem::path GetStorageFile(const std::filesystem::path& storage_directory, const size_t table_index) const
+	{
+		std::string file_name = "random_samples_" + std::to_string(GetProcessNumber()) + "_" + GetName() + "_" + std::to_string(table_index) + ".table";
+		std::replace(file_name.begin(), file_name.end(), ' ', '_');
+
+		return storage_directory / file_name;
+	}
+
+	GenerationKey MakeGenerationKey(const std::uint64_t seed) const
+	{
+		return { distribution_parameters, sampler_config[0], sampler_config[1], engine_type, sampling_mode, seed, truncation_epsilon };
+	}
+
+	// the rows of the table of key are the first rows of the generation of new_key,
+	// the sample size changes every row, so only a grown number of samples qualifies
+	static bool IsAppendable(const GenerationKey& key, const GenerationKey& new_key)
+	{
+		return key.parameters == new_key.parameters &&
+			key.number_samples <= new_key.number_samples &&
+			key.sample_size == new_key.sample_size &&
+			key.engine_type == new_key.engine_type &&
+			key.sampling_mode == new_key.sampling_mode &&
+			key.seed == new_key.seed &&
+			key.truncation_epsilon == new_key.truncation_epsilon;
+	}
+
+	// runs on the job thread, only touches the back table, the back stream and the alias table cache,
+	// a streaming generation reduces every window of the table into the stream,
+	// with append the table holds the first rows of the generation and only the new rows are generated
+	void FillTable(DataTable<ResultTy, RationalTy>& data_table, SampleFunctionStream& stream, DistributionTy distribution, const GenerationKey& key, const StreamingConfig& streaming_config, const bool append, JobControl& job_control)
+	{
+		const std::array<size_t, 2> sampler_config = { key.number_samples, key.sample_size };
+		const EngineTypes engine_type = key.engine_type;
+		const std::uint64_t seed = key.seed;
+
+		stream.Reset(streaming_config);
+		const auto reduce_window = [&data_table, &stream](const size_t)
+		{
+			stream.AddWindow(data_table);
+		};
+
+		std::optional<QuasiRandomSampler<DistributionTy>> quasi_random_sampler;
+		if (key.sampling_mode != pseudo_random)
+		{
+			// parameters without quantile function fall back to pseudo random rows
+			try
+			{
+				quasi_random_sampler.emplace(distribution, key.sampling_mode, sampler_config[1], seed);
+			}
+			catch (const std::exception&)
+			{
+				quasi_random_sampler.reset();
+			}
+		}
+
+		if (quasi_random_sampler.has_value() && streaming_config.enabled)
+		{
+			data_table.StreamQuasiRandomSamples(quasi_random_sampler.value(), sampler_config[0], sampler_config[1], &job_control, reduce_window);
+		}
+		else if (quasi_random_sampler.has_value() && append)
+		{
+			data_table.AppendQuasiRandomSamples(quasi_random_sampler.value(), sampler_config[0], &job_control);
+		}
+		else if (quasi_random_sampler.has_value())
+		{
+			data_table.GenerateQuasiRandomSamples(quasi_random_sampler.value(), sampler_config[0], sampler_config[1], &job_control);
+		}
+		else
+		{
+			alias_table_cache.SetEpsilon(key.truncation_epsilon);
+			const auto sampler = CreateBatchSampler(distribution, alias_table_cache);
+
+			if (streaming_config.enabled)
+			{
+				data_table.StreamSamples(sampler, sampler_config[0], sampler_config[1], engine_type, seed, &job_control, reduce_window);
+			}
+			else if (append)
+			{
+				data_table.AppendSamples(sampler, sampler_config[0], engine_type, seed, &job_control);
+			}
+			else
+			{
+				data_table.GenerateSamples(sampler, sampler_config[0], sampler_config[1], engine_type, seed, &job_control);
+			}
+		}
+
+		if (streaming_config.enabled)
+		{
+			stream.Finish(data_table);
+		}
+	}
 
 	template<typename Dummy = DistributionTy>
 	std::enable_if_t<std::is_same<Dummy, std::uniform_int_distribution<ResultTy>>::value, void>
@@ -210,7 +621,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<int, int>(param_package.a(), param_package.b());
 		}
 		else 
@@ -219,9 +630,8 @@ private:
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
 
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//param1 = std::clamp(param1, param0 + 1, std::numeric_limits<result_t>::max());
 		//_STL_ASSERT(_Min0 <= _Max0, "invalid min and max arguments for uniform_int");
@@ -233,7 +643,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.a(), param_package.b());
 		}
 		else
@@ -242,9 +652,8 @@ private:
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
 
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//float add = std::nextafter(param0, std::numeric_limits<float>::max());
 		//_STL_ASSERT(_Min0 <= _Max0 && (0 <= _Min0 || _Max0 <= _Min0 + (numeric_limits<_Ty>::max)()),
@@ -257,16 +666,15 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<double>(param_package.p());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<double>(parameters[0]);
-			Dummy::param_type param_package;
-			param_package._Init(param0);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 <= _P0 && _P0 <= 1.0, "invalid probability argument for bernoulli_distribution");
 	}
@@ -277,17 +685,16 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
-			SetParameters<ResultTy, double>(param_package.p(), param_package.t());
+			const auto param_package = distribution_parameters;
+			SetParameters<ResultTy, double>(param_package.t(), param_package.p());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<double>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 <= _T0, "invalid max argument for binomial_distribution");
 		//_STL_ASSERT(0.0 <= _P0 && _P0 <= 1.0, "invalid probability argument for binomial_distribution");
@@ -299,17 +706,16 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
-			SetParameters<ResultTy, double>(param_package.p(), param_package.k());
+			const auto param_package = distribution_parameters;
+			SetParameters<ResultTy, double>(param_package.k(), param_package.p());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<double>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _K0, "invalid max argument for "
 		//	"negative_binomial_distribution");
@@ -323,16 +729,15 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<double>(param_package.p());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<double>(parameters[0]);
-			Dummy::param_type param_package;
-			param_package._Init(param0);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _P0 && _P0 < 1.0, "invalid probability argument for geometric_distribution");
 	}
@@ -343,16 +748,15 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<double>(param_package.mean());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<double>(parameters[0]);
-			Dummy::param_type param_package;
-			param_package._Init(param0);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _Mean0, "invalid mean argument for poisson_distribution");
 	}
@@ -363,16 +767,15 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy>(param_package.lambda());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
-			Dummy::param_type param_package;
-			param_package._Init(param0);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _Lambda0, "invalid lambda argument for exponential_distribution");
 	}
@@ -383,7 +786,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.alpha(), param_package.beta());
 		}
 		else
@@ -391,9 +794,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _Alpha0, "invalid alpha argument for gamma_distribution");
 		//_STL_ASSERT(0.0 < _Beta0, "invalid beta argument for gamma_distribution");
@@ -405,7 +807,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.a(), param_package.b());
 		}
 		else
@@ -413,9 +815,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _A0, "invalid a argument for weibull_distribution");
 		//_STL_ASSERT(0.0 < _B0, "invalid b argument for weibull_distribution");
@@ -427,7 +828,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.a(), param_package.b());
 		}
 		else
@@ -435,9 +836,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _B0, "invalid b argument for extreme_value_distribution");
 	}
@@ -448,7 +848,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.mean(), param_package.stddev());
 		}
 		else
@@ -456,9 +856,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _Sigma0, "invalid sigma argument for normal_distribution");
 	}
@@ -469,7 +868,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.m(), param_package.s());
 		}
 		else
@@ -477,9 +876,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _S0, "invalid s argument for lognormal_distribution");
 	}
@@ -490,16 +888,15 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy>(param_package.n());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
-			Dummy::param_type param_package;
-			param_package._Init(param0);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0);
+			distribution_parameters = param_package;
 		}
 		// _STL_ASSERT(0 < _N0, "invalid n argument for chi_squared_distribution");
 	}
@@ -510,7 +907,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.a(), param_package.b());
 		}
 		else
@@ -518,9 +915,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0.0 < _B0, "invalid b argument for cauchy_distribution");
 	}
@@ -531,7 +927,7 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy, ResultTy>(param_package.m(), param_package.n());
 		}
 		else
@@ -539,9 +935,8 @@ private:
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
 			auto param1 = std::any_cast<ResultTy>(parameters[1]);
-			Dummy::param_type param_package;
-			param_package._Init(param0, param1);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0, param1);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0 < _M0, "invalid m argument for fisher_f_distribution");
 		//_STL_ASSERT(0 < _N0, "invalid n argument for fisher_f_distribution");
@@ -553,19 +948,39 @@ private:
 	{
 		if (init)
 		{
-			const auto param_package = random_distribution.param();
+			const auto param_package = distribution_parameters;
 			SetParameters<ResultTy>(param_package.n());
 		}
 		else
 		{
 			auto parameters = GetParameters();
 			auto param0 = std::any_cast<ResultTy>(parameters[0]);
-			Dummy::param_type param_package;
-			param_package._Init(param0);
-			random_distribution.param(param_package);
+			const typename Dummy::param_type param_package(param0);
+			distribution_parameters = param_package;
 		}
 		//_STL_ASSERT(0 < _N0, "invalid n argument for student_t_distribution");
 	}
+
+	// one overload for all boost::math distributions behind an inverse cdf table,
+	// distributions with one parameter ignore the second
+	template<typename Dummy = DistributionTy>
+	std::enable_if_t<IsTabulatedDistribution<Dummy>::value, void>
+		UpdateParameterPackage(const bool init = false)
+	{
+		if (init)
+		{
+			const auto param_package = distribution_parameters;
+			SetParameters<ResultTy, ResultTy>(param_package.GetParameter(0), param_package.GetParameter(1));
+		}
+		else
+		{
+			auto parameters = GetParameters();
+			auto param0 = std::any_cast<ResultTy>(parameters[0]);
+			auto param1 = std::any_cast<ResultTy>(parameters[1]);
+
+			distribution_parameters = typename Dummy::param_type(param0, param1);
+		}
+	}
 };
 
 
@@ -579,26 +994,31 @@ public:
 	using IntegerTy = int;
 
 	
-	using sampler_t00 = typename SamplingManager<std::uniform_int_distribution<IntegerTy>, RationalTy>;
-	using sampler_t01 = typename SamplingManager<std::uniform_real_distribution<RationalTy>, RationalTy>;
-
-	using sampler_t02 = typename SamplingManager<std::bernoulli_distribution, RationalTy>;
-	using sampler_t03 = typename SamplingManager<std::binomial_distribution<IntegerTy>, RationalTy>;
-	using sampler_t04 = typename SamplingManager<std::negative_binomial_distribution<IntegerTy>, RationalTy>;
-	using sampler_t05 = typename SamplingManager<std::geometric_distribution<IntegerTy>, RationalTy>;
-
-	using sampler_t06 = typename SamplingManager<std::poisson_distribution<IntegerTy>, RationalTy>;
-	using sampler_t07 = typename SamplingManager<std::exponential_distribution<RationalTy>, RationalTy>;
-	using sampler_t08 = typename SamplingManager<std::gamma_distribution<RationalTy>, RationalTy>;
-	using sampler_t09 = typename SamplingManager<std::weibull_distribution<RationalTy>, RationalTy>;
-	using sampler_t10 = typename SamplingManager<std::extreme_value_distribution<RationalTy>, RationalTy>;
-
-	using sampler_t11 = typename SamplingManager<std::normal_distribution<RationalTy>, RationalTy>;
-	using sampler_t12 = typename SamplingManager<std::lognormal_distribution<RationalTy>, RationalTy>;
-	using sampler_t13 = typename SamplingManager<std::chi_squared_distribution<RationalTy>, RationalTy>;
-	using sampler_t14 = typename SamplingManager<std::cauchy_distribution<RationalTy>, RationalTy>;
-	using sampler_t15 = typename SamplingManager<std::fisher_f_distribution<RationalTy>, RationalTy>;
-	using sampler_t16 = typename SamplingManager<std::student_t_distribution<RationalTy>, RationalTy>;
+	using sampler_t00 = SamplingManager<std::uniform_int_distribution<IntegerTy>, RationalTy>;
+	using sampler_t01 = SamplingManager<std::uniform_real_distribution<RationalTy>, RationalTy>;
+
+	using sampler_t02 = SamplingManager<std::bernoulli_distribution, RationalTy>;
+	using sampler_t03 = SamplingManager<std::binomial_distribution<IntegerTy>, RationalTy>;
+	using sampler_t04 = SamplingManager<std::negative_binomial_distribution<IntegerTy>, RationalTy>;
+	using sampler_t05 = SamplingManager<std::geometric_distribution<IntegerTy>, RationalTy>;
+
+	using sampler_t06 = SamplingManager<std::poisson_distribution<IntegerTy>, RationalTy>;
+	using sampler_t07 = SamplingManager<std::exponential_distribution<RationalTy>, RationalTy>;
+	using sampler_t08 = SamplingManager<std::gamma_distribution<RationalTy>, RationalTy>;
+	using sampler_t09 = SamplingManager<std::weibull_distribution<RationalTy>, RationalTy>;
+	using sampler_t10 = SamplingManager<std::extreme_value_distribution<RationalTy>, RationalTy>;
+
+	using sampler_t11 = SamplingManager<std::normal_distribution<RationalTy>, RationalTy>;
+	using sampler_t12 = SamplingManager<std::lognormal_distribution<RationalTy>, RationalTy>;
+	using sampler_t13 = SamplingManager<std::chi_squared_distribution<RationalTy>, RationalTy>;
+	using sampler_t14 = SamplingManager<std::cauchy_distribution<RationalTy>, RationalTy>;
+	using sampler_t15 = SamplingManager<std::fisher_f_distribution<RationalTy>, RationalTy>;
+	using sampler_t16 = SamplingManager<std::student_t_distribution<RationalTy>, RationalTy>;
+
+	using sampler_t17 = SamplingManager<TabulatedDistribution<boost::math::beta_distribution<double>, RationalTy>, RationalTy>;
+	using sampler_t18 = SamplingManager<TabulatedDistribution<boost::math::laplace_distribution<double>, RationalTy>, RationalTy>;
+	using sampler_t19 = SamplingManager<TabulatedDistribution<boost::math::logistic_distribution<double>, RationalTy>, RationalTy>;
+	using sampler_t20 = SamplingManager<TabulatedDistribution<boost::math::rayleigh_distribution<double>, RationalTy, 1>, RationalTy>;
 	
 
 	SamplerCollection()
@@ -624,6 +1044,15 @@ public:
 		auto ptr_15 = std::make_unique<sampler_t15>("fisher f", rationale_2, std::vector<std::string>{ "m", "n" });
 		auto ptr_16 = std::make_unique<sampler_t16>("student t", rationale_1, std::vector<std::string>{ "n" });
 
+		auto ptr_17 = std::make_unique<sampler_t17>("beta", rationale_2, std::vector<std::string>{ "alpha", "beta" });
+		auto ptr_18 = std::make_unique<sampler_t18>("laplace", rationale_2, std::vector<std::string>{ "location", "scale" });
+		auto ptr_19 = std::make_unique<sampler_t19>("logistic", rationale_2, std::vector<std::string>{ "location", "scale" });
+		auto ptr_20 = std::make_unique<sampler_t20>("rayleigh", rationale_1, std::vector<std::string>{ "sigma" });
+
+		ptr_17->SetParameters<RationalTy, RationalTy>(2.0f, 5.0f);
+		ptr_18->SetParameters<RationalTy, RationalTy>(0.0f, 1.0f);
+		ptr_19->SetParameters<RationalTy, RationalTy>(0.0f, 1.0f);
+
 		
 		distribution_array[0] = std::move(ptr_00);
 		distribution_array[1] = std::move(ptr_01);
@@ -642,6 +1071,10 @@ public:
 		distribution_array[14] = std::move(ptr_14);
 		distribution_array[15] = std::move(ptr_15);
 		distribution_array[16] = std::move(ptr_16);
+		distribution_array[17] = std::move(ptr_17);
+		distribution_array[18] = std::move(ptr_18);
+		distribution_array[19] = std::move(ptr_19);
+		distribution_array[20] = std::move(ptr_20);
 		
 	}
 
@@ -655,14 +1088,14 @@ public:
 		return distribution_array[index].get();
 	}
 
-	std::string GetName(size_t index)
+	const std::string& GetName(size_t index) const
 	{
 		return distribution_array[index]->GetName();
 	}
 
 private:
 
-	std::array<std::unique_ptr<SamplingManagerInterface>, 17> distribution_array;
+	std::array<std::unique_ptr<SamplingManagerInterface>, 21> distribution_array;
 };
 
 
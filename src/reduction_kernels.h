@@ -0,0 +1,532 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "cpu_dispatch.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <immintrin.h>
+
+
+// Sum, min, max and central moments up to the fourth order.
+// Values are reduced in blocks that fit into the L1 cache, two passes per block:
+// sum, min and max first, then the powers of the deviations from the block mean.
+// Vector kernels keep several accumulators of doubles, so integers can not overflow
+// and float samples do not lose precision with the sample size.
+// Blocks are merged with the pairwise update of Pebay (2008),
+// the block sums are added with Neumaier compensation.
+
+constexpr size_t reduction_block_size = 256;
+constexpr size_t reduction_column_block_rows = 64;
+
+
+struct CentralMoments
+{
+	double count;
+	double sum;
+	double sum_compensation;
+	double mean;
+	double m2;
+	double m3;
+	double m4;
+	double min;
+	double max;
+
+	double Sum() const
+	{
+		return sum + sum_compensation;
+	}
+};
+
+inline CentralMoments EmptyCentralMoments()
+{
+	return { 0, 0, 0, 0, 0, 0, 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+}
+
+inline void MergeMoments(CentralMoments& moments, const CentralMoments& other)
+{
+	if (other.count == 0)
+	{
+		return;
+	}
+	if (moments.count == 0)
+	{
+		moments = other;
+		return;
+	}
+
+	const double count_a = moments.count;
+	const double count_b = other.count;
+	const double count = count_a + count_b;
+	const double delta = other.mean - moments.mean;
+	const double delta_n = delta / count;
+	const double delta_n2 = delta_n * delta_n;
+	const double count_ab = count_a * count_b;
+
+	const double m2 = moments.m2 + other.m2 + delta * delta_n * count_ab;
+	const double m3 = moments.m3 + other.m3 + delta * delta_n2 * count_ab * (count_a - count_b) + 3 * delta_n * (count_a * other.m2 - count_b * moments.m2);
+	const double m4 = moments.m4 + other.m4 + delta * delta_n2 * delta_n * count_ab * (count_a * count_a - count_ab + count_b * count_b)
+		+ 6 * delta_n2 * (count_a * count_a * other.m2 + count_b * count_b * moments.m2) + 4 * delta_n * (count_a * other.m3 - count_b * moments.m3);
+
+	// Neumaier summation
+	const double addend = other.Sum();
+	const double sum = moments.sum + addend;
+	moments.sum_compensation += std::abs(moments.sum) >= std::abs(addend) ? (moments.sum - sum) + addend : (addend - sum) + moments.sum;
+	moments.sum = sum;
+
+	moments.count = count;
+	moments.mean += count_b * delta_n;
+	moments.m2 = m2;
+	moments.m3 = m3;
+	moments.m4 = m4;
+	moments.min = std::min(moments.min, other.min);
+	moments.max = std::max(moments.max, other.max);
+}
+
+
+template<typename Ty>
+struct IsSimdReducible : std::integral_constant<bool,
+	std::is_same<Ty, float>::value || std::is_same<Ty, double>::value || std::is_same<Ty, std::int32_t>::value>
+{};
+
+
+struct BlockSums
+{
+	double sum;
+	double min;
+	double max;
+};
+
+struct BlockPowers
+{
+	double m2;
+	double m3;
+	double m4;
+};
+
+
+SIMD_TARGET("avx2")
+inline __m256d Load4d(const float* values)
+{
+	return _mm256_cvtps_pd(_mm_loadu_ps(values));
+}
+
+SIMD_TARGET("avx2")
+inline __m256d Load4d(const double* values)
+{
+	return _mm256_loadu_pd(values);
+}
+
+SIMD_TARGET("avx2")
+inline __m256d Load4d(const std::int32_t* values)
+{
+	return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+}
+
+SIMD_TARGET("avx512f")
+inline __m512d Load8d(const float* values)
+{
+	return _mm512_cvtps_pd(_mm256_loadu_ps(values));
+}
+
+SIMD_TARGET("avx512f")
+inline __m512d Load8d(const double* values)
+{
+	return _mm512_loadu_pd(values);
+}
+
+SIMD_TARGET("avx512f")
+inline __m512d Load8d(const std::int32_t* values)
+{
+	return _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values)));
+}
+
+
+// row kernels reduce whole vectors from index on
+// and return the index of the first unreduced value
+
+template<typename Ty>
+SIMD_TARGET("avx512f")
+size_t BlockSumsAvx512(const Ty* values, size_t index, const size_t count, BlockSums& sums)
+{
+	__m512d sum_0 = _mm512_setzero_pd();
+	__m512d sum_1 = _mm512_setzero_pd();
+	__m512d min_8 = _mm512_set1_pd(sums.min);
+	__m512d max_8 = _mm512_set1_pd(sums.max);
+
+	for (; index + 16 <= count; index += 16)
+	{
+		const __m512d x_0 = Load8d(values + index);
+		const __m512d x_1 = Load8d(values + index + 8);
+		sum_0 = _mm512_add_pd(sum_0, x_0);
+		sum_1 = _mm512_add_pd(sum_1, x_1);
+		min_8 = _mm512_min_pd(min_8, _mm512_min_pd(x_0, x_1));
+		max_8 = _mm512_max_pd(max_8, _mm512_max_pd(x_0, x_1));
+	}
+
+	sums.sum += _mm512_reduce_add_pd(_mm512_add_pd(sum_0, sum_1));
+	sums.min = _mm512_reduce_min_pd(min_8);
+	sums.max = _mm512_reduce_max_pd(max_8);
+	return index;
+}
+
+template<typename Ty>
+SIMD_TARGET("avx512f")
+size_t BlockPowersAvx512(const Ty* values, size_t index, const size_t count, const double mean, BlockPowers& powers)
+{
+	const __m512d mean_8 = _mm512_set1_pd(mean);
+	__m512d m2_8 = _mm512_setzero_pd();
+	__m512d m3_8 = _mm512_setzero_pd();
+	__m512d m4_8 = _mm512_setzero_pd();
+
+	for (; index + 8 <= count; index += 8)
+	{
+		const __m512d deviation = _mm512_sub_pd(Load8d(values + index), mean_8);
+		const __m512d deviation_2 = _mm512_mul_pd(deviation, deviation);
+		m2_8 = _mm512_add_pd(m2_8, deviation_2);
+		m3_8 = _mm512_add_pd(m3_8, _mm512_mul_pd(deviation_2, deviation));
+		m4_8 = _mm512_add_pd(m4_8, _mm512_mul_pd(deviation_2, deviation_2));
+	}
+
+	powers.m2 += _mm512_reduce_add_pd(m2_8);
+	powers.m3 += _mm512_reduce_add_pd(m3_8);
+	powers.m4 += _mm512_reduce_add_pd(m4_8);
+	return index;
+}
+
+SIMD_TARGET("avx2")
+inline double HorizontalSum4(const __m256d values)
+{
+	const __m128d pairs = _mm_add_pd(_mm256_castpd256_pd128(values), _mm256_extractf128_pd(values, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+}
+
+SIMD_TARGET("avx2")
+inline double HorizontalMin4(const __m256d values)
+{
+	const __m128d pairs = _mm_min_pd(_mm256_castpd256_pd128(values), _mm256_extractf128_pd(values, 1));
+	return _mm_cvtsd_f64(_mm_min_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+}
+
+SIMD_TARGET("avx2")
+inline double HorizontalMax4(const __m256d values)
+{
+	const __m128d pairs = _mm_max_pd(_mm256_castpd256_pd128(values), _mm256_extractf128_pd(values, 1));
+	return _mm_cvtsd_f64(_mm_max_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+}
+
+template<typename Ty>
+SIMD_TARGET("avx2")
+size_t BlockSumsAvx2(const Ty* values, size_t index, const size_t count, BlockSums& sums)
+{
+	__m256d sum_0 = _mm256_setzero_pd();
+	__m256d sum_1 = _mm256_setzero_pd();
+	__m256d min_4 = _mm256_set1_pd(sums.min);
+	__m256d max_4 = _mm256_set1_pd(sums.max);
+
+	for (; index + 8 <= count; index += 8)
+	{
+		const __m256d x_0 = Load4d(values + index);
+		const __m256d x_1 = Load4d(values + index + 4);
+		sum_0 = _mm256_add_pd(sum_0, x_0);
+		sum_1 = _mm256_add_pd(sum_1, x_1);
+		min_4 = _mm256_min_pd(min_4, _mm256_min_pd(x_0, x_1));
+		max_4 = _mm256_max_pd(max_4, _mm256_max_pd(x_0, x_1));
+	}
+
+	sums.sum += HorizontalSum4(_mm256_add_pd(sum_0, sum_1));
+	sums.min = HorizontalMin4(min_4);
+	sums.max = HorizontalMax4(max_4);
+	return index;
+}
+
+template<typename Ty>
+SIMD_TARGET("avx2")
+size_t BlockPowersAvx2(const Ty* values, size_t index, const size_t count, const double mean, BlockPowers& powers)
+{
+	const __m256d mean_4 = _mm256_set1_pd(mean);
+	__m256d m2_4 = _mm256_setzero_pd();
+	__m256d m3_4 = _mm256_setzero_pd();
+	__m256d m4_4 = _mm256_setzero_pd();
+
+	for (; index + 4 <= count; index += 4)
+	{
+		const __m256d deviation = _mm256_sub_pd(Load4d(values + index), mean_4);
+		const __m256d deviation_2 = _mm256_mul_pd(deviation, deviation);
+		m2_4 = _mm256_add_pd(m2_4, deviation_2);
+		m3_4 = _mm256_add_pd(m3_4, _mm256_mul_pd(deviation_2, deviation));
+		m4_4 = _mm256_add_pd(m4_4, _mm256_mul_pd(deviation_2, deviation_2));
+	}
+
+	powers.m2 += HorizontalSum4(m2_4);
+	powers.m3 += HorizontalSum4(m3_4);
+	powers.m4 += HorizontalSum4(m4_4);
+	return index;
+}
+
+
+// count values at the given stride, at most one block
+template<typename Ty>
+CentralMoments ReduceStridedBlock(const Ty* values, const size_t count, const size_t stride)
+{
+	BlockSums sums = { 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+	for (size_t index = 0; index < count; ++index)
+	{
+		const double value = static_cast<double>(values[index * stride]);
+		sums.sum += value;
+		sums.min = std::min(sums.min, value);
+		sums.max = std::max(sums.max, value);
+	}
+
+	const double mean = sums.sum / static_cast<double>(count);
+
+	BlockPowers powers = { 0, 0, 0 };
+	for (size_t index = 0; index < count; ++index)
+	{
+		const double deviation = static_cast<double>(values[index * stride]) - mean;
+		const double deviation_2 = deviation * deviation;
+		powers.m2 += deviation_2;
+		powers.m3 += deviation_2 * deviation;
+		powers.m4 += deviation_2 * deviation_2;
+	}
+
+	return { static_cast<double>(count), sums.sum, 0, mean, powers.m2, powers.m3, powers.m4, sums.min, sums.max };
+}
+
+// count contiguous values, at most one block
+template<typename Ty>
+CentralMoments ReduceBlock(const Ty* values, const size_t count)
+{
+	if constexpr (!IsSimdReducible<Ty>::value)
+	{
+		return ReduceStridedBlock(values, count, 1);
+	}
+	else
+	{
+		const SimdLevels simd_level = GetSimdLevel();
+
+		BlockSums sums = { 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+		size_t index = 0;
+
+		if (simd_level == simd_avx512)
+		{
+			index = BlockSumsAvx512(values, index, count, sums);
+		}
+		if (simd_level >= simd_avx2)
+		{
+			index = BlockSumsAvx2(values, index, count, sums);
+		}
+		for (; index < count; ++index)
+		{
+			const double value = static_cast<double>(values[index]);
+			sums.sum += value;
+			sums.min = std::min(sums.min, value);
+			sums.max = std::max(sums.max, value);
+		}
+
+		const double mean = sums.sum / static_cast<double>(count);
+
+		BlockPowers powers = { 0, 0, 0 };
+		index = 0;
+
+		if (simd_level == simd_avx512)
+		{
+			index = BlockPowersAvx512(values, index, count, mean, powers);
+		}
+		if (simd_level >= simd_avx2)
+		{
+			index = BlockPowersAvx2(values, index, count, mean, powers);
+		}
+		for (; index < count; ++index)
+		{
+			const double deviation = static_cast<double>(values[index]) - mean;
+			const double deviation_2 = deviation * deviation;
+			powers.m2 += deviation_2;
+			powers.m3 += deviation_2 * deviation;
+			powers.m4 += deviation_2 * deviation_2;
+		}
+
+		return { static_cast<double>(count), sums.sum, 0, mean, powers.m2, powers.m3, powers.m4, sums.min, sums.max };
+	}
+}
+
+
+// moments of count contiguous values, a whole row of the sample matrix
+template<typename Ty>
+CentralMoments ReduceRow(const Ty* values, const size_t count)
+{
+	CentralMoments moments = EmptyCentralMoments();
+
+	for (size_t offset = 0; offset < count; offset += reduction_block_size)
+	{
+		MergeMoments(moments, ReduceBlock(values + offset, std::min(reduction_block_size, count - offset)));
+	}
+
+	return moments;
+}
+
+
+// column kernels reduce the rows of a block column wise, one column per lane,
+// from column on and return the first unreduced column
+
+template<typename Ty>
+SIMD_TARGET("avx512f")
+size_t ReduceColumnsAvx512(const Ty* values, const size_t rows, size_t column, const size_t columns, const size_t row_stride, CentralMoments* column_moments)
+{
+	const __m512d rows_8 = _mm512_set1_pd(static_cast<double>(rows));
+
+	for (; column + 8 <= columns; column += 8)
+	{
+		__m512d sum_8 = _mm512_setzero_pd();
+		__m512d min_8 = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+		__m512d max_8 = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+
+		for (size_t row = 0; row < rows; ++row)
+		{
+			const __m512d x = Load8d(values + row * row_stride + column);
+			sum_8 = _mm512_add_pd(sum_8, x);
+			min_8 = _mm512_min_pd(min_8, x);
+			max_8 = _mm512_max_pd(max_8, x);
+		}
+
+		const __m512d mean_8 = _mm512_div_pd(sum_8, rows_8);
+		__m512d m2_8 = _mm512_setzero_pd();
+		__m512d m3_8 = _mm512_setzero_pd();
+		__m512d m4_8 = _mm512_setzero_pd();
+
+		for (size_t row = 0; row < rows; ++row)
+		{
+			const __m512d deviation = _mm512_sub_pd(Load8d(values + row * row_stride + column), mean_8);
+			const __m512d deviation_2 = _mm512_mul_pd(deviation, deviation);
+			m2_8 = _mm512_add_pd(m2_8, deviation_2);
+			m3_8 = _mm512_add_pd(m3_8, _mm512_mul_pd(deviation_2, deviation));
+			m4_8 = _mm512_add_pd(m4_8, _mm512_mul_pd(deviation_2, deviation_2));
+		}
+
+		alignas(64) double lanes[7][8];
+		_mm512_store_pd(lanes[0], sum_8);
+		_mm512_store_pd(lanes[1], mean_8);
+		_mm512_store_pd(lanes[2], m2_8);
+		_mm512_store_pd(lanes[3], m3_8);
+		_mm512_store_pd(lanes[4], m4_8);
+		_mm512_store_pd(lanes[5], min_8);
+		_mm512_store_pd(lanes[6], max_8);
+
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			MergeMoments(column_moments[column + lane], { static_cast<double>(rows), lanes[0][lane], 0, lanes[1][lane], lanes[2][lane], lanes[3][lane], lanes[4][lane], lanes[5][lane], lanes[6][lane] });
+		}
+	}
+
+	return column;
+}
+
+template<typename Ty>
+SIMD_TARGET("avx2")
+size_t ReduceColumnsAvx2(const Ty* values, const size_t rows, size_t column, const size_t columns, const size_t row_stride, CentralMoments* column_moments)
+{
+	const __m256d rows_4 = _mm256_set1_pd(static_cast<double>(rows));
+
+	for (; column + 4 <= columns; column += 4)
+	{
+		__m256d sum_4 = _mm256_setzero_pd();
+		__m256d min_4 = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+		__m256d max_4 = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+
+		for (size_t row = 0; row < rows; ++row)
+		{
+			const __m256d x = Load4d(values + row * row_stride + column);
+			sum_4 = _mm256_add_pd(sum_4, x);
+			min_4 = _mm256_min_pd(min_4, x);
+			max_4 = _mm256_max_pd(max_4, x);
+		}
+
+		const __m256d mean_4 = _mm256_div_pd(sum_4, rows_4);
+		__m256d m2_4 = _mm256_setzero_pd();
+		__m256d m3_4 = _mm256_setzero_pd();
+		__m256d m4_4 = _mm256_setzero_pd();
+
+		for (size_t row = 0; row < rows; ++row)
+		{
+			const __m256d deviation = _mm256_sub_pd(Load4d(values + row * row_stride + column), mean_4);
+			const __m256d deviation_2 = _mm256_mul_pd(deviation, deviation);
+			m2_4 = _mm256_add_pd(m2_4, deviation_2);
+			m3_4 = _mm256_add_pd(m3_4, _mm256_mul_pd(deviation_2, deviation));
+			m4_4 = _mm256_add_pd(m4_4, _mm256_mul_pd(deviation_2, deviation_2));
+		}
+
+		alignas(32) double lanes[7][4];
+		_mm256_store_pd(lanes[0], sum_4);
+		_mm256_store_pd(lanes[1], mean_4);
+		_mm256_store_pd(lanes[2], m2_4);
+		_mm256_store_pd(lanes[3], m3_4);
+		_mm256_store_pd(lanes[4], m4_4);
+		_mm256_store_pd(lanes[5], min_4);
+		_mm256_store_pd(lanes[6], max_4);
+
+		for (size_t lane = 0; lane < 4; ++lane)
+		{
+			MergeMoments(column_moments[column + lane], { static_cast<double>(rows), lanes[0][lane], 0, lanes[1][lane], lanes[2][lane], lanes[3][lane], lanes[4][lane], lanes[5][lane], lanes[6][lane] });
+		}
+	}
+
+	return column;
+}
+
+
+// merges the rows of a row major block into one accumulator per column,
+// column_moments holds columns accumulators
+template<typename Ty>
+void ReduceColumns(const Ty* values, const size_t rows, const size_t columns, const size_t row_stride, CentralMoments* column_moments)
+{
+	const SimdLevels simd_level = GetSimdLevel();
+
+	for (size_t row_offset = 0; row_offset < rows; row_offset += reduction_column_block_rows)
+	{
+		const size_t block_rows = std::min(reduction_column_block_rows, rows - row_offset);
+		const Ty* block = values + row_offset * row_stride;
+
+		size_t column = 0;
+
+		if constexpr (IsSimdReducible<Ty>::value)
+		{
+			if (simd_level == simd_avx512)
+			{
+				column = ReduceColumnsAvx512(block, block_rows, column, columns, row_stride, column_moments);
+			}
+			if (simd_level >= simd_avx2)
+			{
+				column = ReduceColumnsAvx2(block, block_rows, column, columns, row_stride, column_moments);
+			}
+		}
+
+		for (; column < columns; ++column)
+		{
+			MergeMoments(column_moments[column], ReduceStridedBlock(block + column, block_rows, row_stride));
+		}
+	}
+}
@@ -0,0 +1,162 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "histogram.h"
+#include "reduction_kernels.h"
+
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+
+// histogram limits of a streaming generation,
+// they have to be known before the samples are thrown away
+struct StreamingConfig
+{
+	bool enabled;
+	unsigned int number_bins;
+	float lower_limit;
+	float upper_limit;
+};
+
+
+// Moments and histogram of every sample function over all rows of a streaming generation.
+// Each window of rows is reduced before the table overwrites it with the next window,
+// memory only depends on the window and the number of bins.
+class SampleFunctionStream
+{
+public:
+
+	SampleFunctionStream() :
+		active(false),
+		number_rows(0)
+	{}
+
+	void Reset(const StreamingConfig& config)
+	{
+		active = config.enabled;
+		number_rows = 0;
+		lower_limit = config.lower_limit;
+		upper_limit = config.upper_limit;
+		histogram_config.SetNumberBins(config.number_bins);
+
+		names.clear();
+		moments.clear();
+		histograms.clear();
+	}
+
+	// the sample function names are taken from the first window
+	template<typename DataTableTy>
+	void AddWindow(const DataTableTy& data_table)
+	{
+		AddNames(data_table);
+
+		for (size_t index = 0; index < names.size(); ++index)
+		{
+			const auto results = data_table.GetColumnView(names[index]);
+
+			MergeMoments(moments[index], ReduceRow(results.data(), results.size()));
+			histogram_config.AddToHistogram(histograms[index], results);
+		}
+
+		number_rows += data_table.GetNumberRows();
+	}
+
+	// turns the counts into relative frequencies like Histogram::SetHistogram,
+	// a generation without rows has empty moments and histograms of every sample function of the table
+	template<typename DataTableTy>
+	void Finish(const DataTableTy& data_table)
+	{
+		AddNames(data_table);
+
+		if (number_rows == 0)
+		{
+			return;
+		}
+
+		for (auto& histogram : histograms)
+		{
+			histogram *= 1.0 / static_cast<double>(number_rows);
+		}
+	}
+
+	// false for results of a generation that kept its samples
+	bool IsActive() const
+	{
+		return active;
+	}
+
+	size_t GetNumberRows() const
+	{
+		return number_rows;
+	}
+
+	const std::vector<std::string>& GetNames() const
+	{
+		return names;
+	}
+
+	const RegularHistogram& GetHistogram(const std::string& name) const
+	{
+		return histograms[GetIndex(name)];
+	}
+
+	const CentralMoments& GetMoments(const std::string& name) const
+	{
+		return moments[GetIndex(name)];
+	}
+
+private:
+
+	template<typename DataTableTy>
+	void AddNames(const DataTableTy& data_table)
+	{
+		if (names.empty())
+		{
+			names = data_table.GetSampleFunctionNames();
+			moments.assign(names.size(), EmptyCentralMoments());
+			histograms.assign(names.size(), histogram_config.MakeHistogram(lower_limit, upper_limit));
+		}
+	}
+
+	size_t GetIndex(const std::string& name) const
+	{
+		const auto found = std::find(names.cbegin(), names.cend(), name);
+
+		found == names.cend() ? throw std::logic_error("sample function stream: name not found") : false;
+
+		return static_cast<size_t>(found - names.cbegin());
+	}
+
+	bool active;
+	size_t number_rows;
+	float lower_limit;
+	float upper_limit;
+	Histogram histogram_config;
+
+	std::vector<std::string> names;
+	std::vector<CentralMoments> moments;
+	std::vector<RegularHistogram> histograms;
+};
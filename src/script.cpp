@@ -70,6 +70,17 @@ int main(int argc, char *argv[])
 
 	licenses[6][0] = "embed-resource";
 	licenses[6][1] = LOAD_RESOURCE(embed_resource_LICENSE).toString();
+
+	// the read only text buffers and widget ids are built once, not per frame
+	std::vector<std::vector<char>> license_texts(licenses.size());
+	std::vector<std::string> license_ids(licenses.size());
+
+	for (size_t index = 0; index < licenses.size(); ++index)
+	{
+		license_texts[index].assign(licenses[index][1].cbegin(), licenses[index][1].cend());
+		license_texts[index].push_back('\0');
+		license_ids[index] = "##" + licenses[index][0];
+	}
 	
 	////////////////////////////////////////////////////////////////////////////////
 
@@ -113,12 +124,35 @@ int main(int argc, char *argv[])
 
 	const float axis_gap = 50;
 	int random_distribution_index = 11;
+	int engine_type_index = GetDefaultEngineType();
+	int sampling_mode_index = pseudo_random;
+	bool fixed_seed = false;
+	bool streaming = false;
+	bool out_of_core = false;
+	ImU64 seed = 0;
 	int number_samples = 1000;
 	int sample_size = 1;
 	int sample_functions_index = 1;
-	std::vector<float> current_histogram_data;
+	const auto engine_names = GetEngineNames();
+	const auto sampling_mode_names = GetSamplingModeNames();
+
+	// the histogram is only refilled when its data, its bins or its limits change,
+	// the data is a view into the table of histogram_distribution
+	StridedView<const float> current_histogram_data;
+	const SamplingManagerInterface* histogram_distribution = nullptr;
+	std::uint64_t histogram_generation = 0;
+	int histogram_function_index = -1;
+	bool histogram_data_changed = true;
+	bool histogram_streamed = false;
+	unsigned int histogram_number_bins = 0;
+	std::array<float, 2> histogram_limits = { 0.f, 0.f };
+	RegularHistogram current_histogram;
 	bool single_startup_trigger = true;
 
+	// scratch directory of out of core tables, empty if the system has none
+	std::error_code temp_directory_error;
+	const std::filesystem::path temp_directory = std::filesystem::temp_directory_path(temp_directory_error);
+
 	plot_histogram.SetNumberBins(80);
 	
 	bool open_all = true;
@@ -133,6 +167,10 @@ int main(int argc, char *argv[])
 
 		////////////////////////////////////////////////////////////////////////////////
 
+		// a generation that finished since the last frame is published here,
+		// before anything of this frame reads the results
+		sampler_collection.GetDistribution(random_distribution_index)->SwapResults();
+
 		const auto fm_size = glfw_interface.GetFrambufferSize();
 
 		ImGui::SetNextWindowPos(glm::vec2(static_cast<float>(fm_size[0]) / 2.f, 0), ImGuiCond_Always);
@@ -147,7 +185,7 @@ int main(int argc, char *argv[])
 			const float item_width = ImGui::GetContentRegionAvail().x * 0.2f;
 			const float half_avail = ImGui::GetContentRegionAvail().x * 0.5f;
 
-			std::string distribution_combo_label = sampler_collection.GetName(random_distribution_index).c_str();
+			const std::string& distribution_combo_label = sampler_collection.GetName(random_distribution_index);
 
 			if (ImGui::BeginCombo("Random Distribution", distribution_combo_label.c_str()))
 			{
@@ -168,7 +206,62 @@ int main(int argc, char *argv[])
 				ImGui::EndCombo();
 			}
 
-			const std::string format_string = "%.2f";
+			bool engine_config_changed = false;
+
+			if (ImGui::BeginCombo("Random Engine", engine_names[engine_type_index].c_str()))
+			{
+				for (int index = 0; index < engine_names.size(); ++index)
+				{
+					const bool is_selected = (engine_type_index == index);
+
+					if (ImGui::Selectable(engine_names[index].c_str(), is_selected))
+					{
+						engine_config_changed = engine_type_index != index;
+						engine_type_index = index;
+					}
+					if (is_selected)
+					{
+						ImGui::SetItemDefaultFocus();
+					}
+				}
+				ImGui::EndCombo();
+			}
+
+			if (ImGui::BeginCombo("Sampling Mode", sampling_mode_names[sampling_mode_index].c_str()))
+			{
+				for (int index = 0; index < sampling_mode_names.size(); ++index)
+				{
+					const bool is_selected = (sampling_mode_index == index);
+
+					if (ImGui::Selectable(sampling_mode_names[index].c_str(), is_selected))
+					{
+						engine_config_changed |= sampling_mode_index != index;
+						sampling_mode_index = index;
+					}
+					if (is_selected)
+					{
+						ImGui::SetItemDefaultFocus();
+					}
+				}
+				ImGui::EndCombo();
+			}
+
+			const float item_width_seed = ImGui::GetContentRegionAvail().x * 0.3f;
+
+			engine_config_changed |= ImGui::Checkbox("fixed seed", &fixed_seed);
+			ImGui::SameLine(half_avail);
+			ImGui::SetNextItemWidth(item_width_seed);
+			engine_config_changed |= ImGui::InputScalar("seed", ImGuiDataType_U64, &seed) && fixed_seed;
+
+			// only the histograms and moments of the sample functions are kept,
+			// for sample counts that do not fit into memory
+			engine_config_changed |= ImGui::Checkbox("streaming", &streaming);
+
+			// the samples are kept in memory mapped files in the temporary directory
+			ImGui::SameLine(half_avail);
+			engine_config_changed |= ImGui::Checkbox("out of core", &out_of_core);
+
+			const char* format_string = "%.2f";
 			const float input_step = 0.1f;
 
 			auto current_distribution = sampler_collection.GetDistribution(random_distribution_index);
@@ -198,11 +291,11 @@ int main(int argc, char *argv[])
 				auto param1 = std::any_cast<float>(params[1]);
 
 				ImGui::SetNextItemWidth(item_width);
-				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[0].c_str(), &param0, input_step, input_step, format_string.c_str());
+				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[0].c_str(), &param0, input_step, input_step, format_string);
 
 				ImGui::SameLine(half_avail);
 				ImGui::SetNextItemWidth(item_width);
-				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[1].c_str(), &param1, input_step, input_step, format_string.c_str());
+				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[1].c_str(), &param1, input_step, input_step, format_string);
 
 				current_distribution->SetParameters<float, float>(param0, param1);
 
@@ -213,7 +306,7 @@ int main(int argc, char *argv[])
 				auto param0 = std::any_cast<float>(params[0]);
 
 				ImGui::SetNextItemWidth(item_width);
-				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[0].c_str(), &param0, input_step, input_step, format_string.c_str());
+				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[0].c_str(), &param0, input_step, input_step, format_string);
 
 				current_distribution->SetParameters<float>(param0);
 			}
@@ -224,7 +317,7 @@ int main(int argc, char *argv[])
 				auto param0 = static_cast<float>(std::any_cast<double>(params[0]));
 
 				ImGui::SetNextItemWidth(item_width);
-				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[0].c_str(), &param0, input_step, input_step, format_string.c_str());
+				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[0].c_str(), &param0, input_step, input_step, format_string);
 
 				current_distribution->SetParameters<double>(static_cast<double>(param0));
 			}
@@ -240,7 +333,7 @@ int main(int argc, char *argv[])
 
 				ImGui::SameLine(half_avail);
 				ImGui::SetNextItemWidth(item_width);
-				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[1].c_str(), &param1, input_step, input_step, format_string.c_str());
+				parameters_changed += ImGui::InputFloat(current_distribution->GetParameterNames()[1].c_str(), &param1, input_step, input_step, format_string);
 
 				current_distribution->SetParameters<int, double>(param0, static_cast<double>(param1));
 			}
@@ -258,21 +351,44 @@ int main(int argc, char *argv[])
 			sampler_config_changed = ImGui::InputInt("samples size", &sample_size, 1, 10);
 
 			current_distribution->SetSamplerConfig(number_samples, sample_size);
+			current_distribution->SetEngineType(static_cast<EngineTypes>(engine_type_index));
+			current_distribution->SetSamplingMode(static_cast<SamplingModes>(sampling_mode_index));
+			current_distribution->SetSeed(fixed_seed ? std::optional<std::uint64_t>(seed) : std::nullopt);
+			current_distribution->SetStreaming({ streaming, plot_histogram.GetNumberBins(), histogram_limits[0], histogram_limits[1] });
+			current_distribution->SetStorageDirectory(out_of_core && !temp_directory.empty() ? std::optional<std::filesystem::path>(temp_directory) : std::nullopt);
 
-			if (ImGui::Button("(re-)generate samples") || sampler_config_changed || parameters_changed || single_startup_trigger)
+			if (ImGui::Button("(re-)generate samples") || sampler_config_changed || parameters_changed || engine_config_changed || single_startup_trigger)
 			{
-				current_distribution->GenerateSamples();
+				current_distribution->GenerateSamplesAsync();
 				single_startup_trigger = false;
 			}
 
-			auto sample_function_names = current_distribution->GetSampleFunctionNames();
-			std::string sample_function_combo_label = "none";
+			if (current_distribution->IsGenerating())
+			{
+				ImGui::SameLine();
+				ImGui::ProgressBar(current_distribution->GetGenerationProgress(), ImVec2(item_width, 0));
+			}
+
+			// the results of the last successful generation stay on display
+			const auto generation_error = current_distribution->GetGenerationError();
+			if (generation_error.has_value())
+			{
+				ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "generation failed: %s", generation_error->c_str());
+			}
+
+			if (!fixed_seed)
+			{
+				seed = current_distribution->GetLastSeed();
+			}
+
+			const auto& sample_function_names = current_distribution->GetSampleFunctionNames();
+			const char* sample_function_combo_label = "none";
 			if (sample_function_names.size() > 0)
 			{
-				sample_function_combo_label = sample_function_names[sample_functions_index];
+				sample_function_combo_label = sample_function_names[sample_functions_index].c_str();
 			}
 			 
-			if (ImGui::BeginCombo("sample function results", sample_function_combo_label.c_str()))
+			if (ImGui::BeginCombo("sample function results", sample_function_combo_label))
 			{
 				for (int index = 0; index < sample_function_names.size(); ++index)
 				{
@@ -290,11 +406,6 @@ int main(int argc, char *argv[])
 				}
 				ImGui::EndCombo();
 			}
-
-			if (sample_function_names.size() > 0)
-			{
-				current_histogram_data = std::any_cast<std::vector<float>>(current_distribution->GetSampleFunctionResults(sample_function_combo_label));
-			}
 		}
 
 		ImGui::SetNextItemOpen(true, ImGuiCond_Once);
@@ -320,22 +431,22 @@ int main(int argc, char *argv[])
 			const float half_avail = ImGui::GetContentRegionAvail().x * 0.5f;
 
 			const float input_step = 0.5f;
-			const std::string format_string = "%.2f";
+			const char* format_string = "%.2f";
 
 			ImGui::SetNextItemWidth(item_width);
-			ImGui::InputFloat("X-Axis Lower Limit", &axes[0], input_step, input_step, format_string.c_str());
+			ImGui::InputFloat("X-Axis Lower Limit", &axes[0], input_step, input_step, format_string);
 
 			ImGui::SameLine(half_avail);
 			ImGui::SetNextItemWidth(item_width);
-			ImGui::InputFloat("Y-Axis Lower Limit", &axes[2], input_step, input_step, format_string.c_str());
+			ImGui::InputFloat("Y-Axis Lower Limit", &axes[2], input_step, input_step, format_string);
 			
 			
 			ImGui::SetNextItemWidth(item_width);
-			ImGui::InputFloat("X-Axis Upper Limit", &axes[1], input_step, input_step, format_string.c_str());
+			ImGui::InputFloat("X-Axis Upper Limit", &axes[1], input_step, input_step, format_string);
 
 			ImGui::SameLine(half_avail);
 			ImGui::SetNextItemWidth(item_width);
-			ImGui::InputFloat("Y-Axis Upper Limit", &axes[3], input_step, input_step, format_string.c_str());
+			ImGui::InputFloat("Y-Axis Upper Limit", &axes[3], input_step, input_step, format_string);
 
 			plot.SetAxes(axes);
 			
@@ -344,11 +455,11 @@ int main(int argc, char *argv[])
 			auto gaps = plot.GetGridGaps();
 
 			ImGui::SetNextItemWidth(item_width);
-			ImGui::InputFloat("X-Axis Grid Gap", &gaps[0], input_step, input_step, format_string.c_str());
+			ImGui::InputFloat("X-Axis Grid Gap", &gaps[0], input_step, input_step, format_string);
 			
 			ImGui::SameLine(half_avail);
 			ImGui::SetNextItemWidth(item_width);
-			ImGui::InputFloat("Y-Axis Grid Gap", &gaps[1], input_step, input_step, format_string.c_str());
+			ImGui::InputFloat("Y-Axis Grid Gap", &gaps[1], input_step, input_step, format_string);
 
 			plot.SetGridGaps(gaps);			
 		}
@@ -371,10 +482,8 @@ int main(int argc, char *argv[])
 			{
 				if (ImGui::TreeNode(licenses[index][0].c_str()))
 				{
-					std::vector<char> license_text(licenses[index][1].cbegin(), licenses[index][1].cend());
-
-					ImGui::InputTextMultiline((std::string("##") + licenses[index][0]).c_str(), 
-						license_text.data(), license_text.size(), 
+					ImGui::InputTextMultiline(license_ids[index].c_str(), 
+						license_texts[index].data(), license_texts[index].size(), 
 						ImVec2(0, 0), ImGuiInputTextFlags_ReadOnly); //ImGuiInputTextFlags_Multiline
 					ImGui::TreePop();
 				}
@@ -408,9 +517,54 @@ int main(int argc, char *argv[])
 		plot.ProceedGrid();
 		plot.SetPlotCurve(normal_distribution);
 
-		auto histogram = plot_histogram.SetHistogram(current_histogram_data, plot.GetScrolledAxes()[0], plot.GetScrolledAxes()[1]);
+		// also with collapsed headers, a swapped table must not be read through an old view
+		{
+			const auto current_distribution = sampler_collection.GetDistribution(random_distribution_index);
+			const auto& sample_function_names = current_distribution->GetSampleFunctionNames();
+
+			const bool histogram_source_changed = current_distribution != histogram_distribution || 
+				current_distribution->GetGeneration() != histogram_generation || 
+				sample_functions_index != histogram_function_index;
+
+			if (sample_function_names.size() > 0 && histogram_source_changed && current_distribution->IsStreaming())
+			{
+				// the streamed histogram has the bins and limits of the generation
+				current_histogram = current_distribution->GetSampleFunctionStream().GetHistogram(sample_function_names[sample_functions_index]);
+				current_histogram_data = StridedView<const float>();
+
+				histogram_distribution = current_distribution;
+				histogram_generation = current_distribution->GetGeneration();
+				histogram_function_index = sample_functions_index;
+				histogram_streamed = true;
+			}
+			else if (sample_function_names.size() > 0 && histogram_source_changed)
+			{
+				current_histogram_data = std::any_cast<StridedView<const float>>(current_distribution->GetSampleFunctionResultsView(sample_function_names[sample_functions_index]));
+
+				histogram_distribution = current_distribution;
+				histogram_generation = current_distribution->GetGeneration();
+				histogram_function_index = sample_functions_index;
+				histogram_data_changed = true;
+				histogram_streamed = false;
+			}
+		}
+
+		const auto scrolled_axes = plot.GetScrolledAxes();
+
+		const bool histogram_view_changed = histogram_number_bins != plot_histogram.GetNumberBins() || 
+			histogram_limits[0] != scrolled_axes[0] || histogram_limits[1] != scrolled_axes[1];
+
+		// a streamed histogram can not be refilled, the next generation uses the new bins and limits
+		if (!histogram_streamed && (histogram_data_changed || histogram_view_changed))
+		{
+			current_histogram = plot_histogram.SetHistogram(current_histogram_data, scrolled_axes[0], scrolled_axes[1]);
+			histogram_data_changed = false;
+		}
+
+		histogram_number_bins = plot_histogram.GetNumberBins();
+		histogram_limits = { scrolled_axes[0], scrolled_axes[1] };
 
-		plot.SetHistogram(histogram);
+		plot.SetHistogram(current_histogram);
 
 		plot.Draw();
 
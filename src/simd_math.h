@@ -0,0 +1,90 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "cpu_dispatch.h"
+
+#include <cstddef>
+#include <cmath>
+#include <immintrin.h>
+
+
+// Cephes expf: n = round(x / ln 2), exp(x) = 2^n * exp(x - n ln 2),
+// degree 5 polynomial on [-ln 2 / 2, ln 2 / 2], relative error < 2 ulp,
+// arguments are clamped to the finite float range
+SIMD_TARGET("avx2")
+inline __m256 Exp8(__m256 x)
+{
+	x = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f));
+	x = _mm256_max_ps(x, _mm256_set1_ps(-87.3365447504019f));
+
+	const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+	__m256 r = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+	r = _mm256_sub_ps(r, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+	__m256 p = _mm256_set1_ps(1.9875691500e-4f);
+	p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.3981999507e-3f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(8.3334519073e-3f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(4.1665795894e-2f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.6666665459e-1f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(5.0000001201e-1f));
+	p = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(p, r), r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+	const __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+	return _mm256_mul_ps(p, _mm256_castsi256_ps(exponent));
+}
+
+SIMD_TARGET("avx2")
+inline size_t ExpBatchAvx2(float* values, size_t index, const size_t count)
+{
+	for (; index + 8 <= count; index += 8)
+	{
+		_mm256_storeu_ps(values + index, Exp8(_mm256_loadu_ps(values + index)));
+	}
+	return index;
+}
+
+
+// values[i] = exp(values[i])
+inline void ExpBatch(float* values, const size_t count)
+{
+	size_t index = 0;
+
+	if (GetSimdLevel() >= simd_avx2)
+	{
+		index = ExpBatchAvx2(values, index, count);
+	}
+
+	for (; index < count; ++index)
+	{
+		values[index] = std::exp(values[index]);
+	}
+}
+
+inline void ExpBatch(double* values, const size_t count)
+{
+	for (size_t index = 0; index < count; ++index)
+	{
+		values[index] = std::exp(values[index]);
+	}
+}
@@ -0,0 +1,112 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+
+// Lock free ring buffer for exactly one producer thread and one consumer thread.
+// The positions only grow, their difference is the number of stored values,
+// each side publishes its position with release and reads the other with acquire.
+template<typename ValueTy>
+class SpscRingBuffer
+{
+public:
+
+	// capacity is rounded up to a power of two
+	SpscRingBuffer(const size_t capacity) :
+		write_position(0),
+		read_position(0),
+		values(RoundUpToPowerOfTwo(capacity))
+	{
+		mask = values.size() - 1;
+	}
+
+	SpscRingBuffer(const SpscRingBuffer&) = delete;
+	SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+	size_t GetCapacity() const
+	{
+		return values.size();
+	}
+
+	// approximate for the thread not owning the buffer side
+	size_t GetSize() const
+	{
+		const size_t read = read_position.load(std::memory_order_acquire);
+		const size_t write = write_position.load(std::memory_order_acquire);
+		return write - read;
+	}
+
+	// producer, returns the number of values stored
+	size_t Push(const ValueTy* source, const size_t count)
+	{
+		const size_t write = write_position.load(std::memory_order_relaxed);
+		const size_t read = read_position.load(std::memory_order_acquire);
+		const size_t number_values = std::min(count, values.size() - (write - read));
+
+		for (size_t index = 0; index < number_values; ++index)
+		{
+			values[(write + index) & mask] = source[index];
+		}
+
+		write_position.store(write + number_values, std::memory_order_release);
+		return number_values;
+	}
+
+	// consumer, returns the number of values taken
+	size_t Pop(ValueTy* destination, const size_t count)
+	{
+		const size_t read = read_position.load(std::memory_order_relaxed);
+		const size_t write = write_position.load(std::memory_order_acquire);
+		const size_t number_values = std::min(count, write - read);
+
+		for (size_t index = 0; index < number_values; ++index)
+		{
+			destination[index] = values[(read + index) & mask];
+		}
+
+		read_position.store(read + number_values, std::memory_order_release);
+		return number_values;
+	}
+
+private:
+
+	static size_t RoundUpToPowerOfTwo(const size_t capacity)
+	{
+		size_t power = 1;
+		while (power < capacity)
+		{
+			power <<= 1;
+		}
+		return power;
+	}
+
+	// on separate cache lines, each is written by one thread only
+	alignas(64) std::atomic<size_t> write_position;
+	alignas(64) std::atomic<size_t> read_position;
+	alignas(64) size_t mask;
+	std::vector<ValueTy> values;
+};
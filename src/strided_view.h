@@ -0,0 +1,142 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <type_traits>
+
+
+// Non owning view of count values that are stride values apart,
+// stride 1 is a contiguous range, stride sample_size a column of the sample matrix.
+// A view stays valid until the storage it points into is regenerated or resized.
+template<typename Ty>
+class StridedView
+{
+public:
+
+	using value_type = typename std::remove_const<Ty>::type;
+
+	class Iterator
+	{
+	public:
+
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = typename std::remove_const<Ty>::type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Ty*;
+		using reference = Ty&;
+
+		Iterator(Ty* position, const size_t stride) :
+			position(position),
+			stride(stride)
+		{}
+
+		reference operator*() const { return *position; }
+		reference operator[](const difference_type offset) const { return *(position + offset * static_cast<difference_type>(stride)); }
+
+		Iterator& operator++() { position += stride; return *this; }
+		Iterator operator++(int) { Iterator previous = *this; position += stride; return previous; }
+		Iterator& operator--() { position -= stride; return *this; }
+		Iterator operator--(int) { Iterator previous = *this; position -= stride; return previous; }
+		Iterator& operator+=(const difference_type offset) { position += offset * static_cast<difference_type>(stride); return *this; }
+		Iterator& operator-=(const difference_type offset) { position -= offset * static_cast<difference_type>(stride); return *this; }
+		Iterator operator+(const difference_type offset) const { Iterator moved = *this; return moved += offset; }
+		Iterator operator-(const difference_type offset) const { Iterator moved = *this; return moved -= offset; }
+		difference_type operator-(const Iterator& other) const { return (position - other.position) / static_cast<difference_type>(stride); }
+
+		bool operator==(const Iterator& other) const { return position == other.position; }
+		bool operator!=(const Iterator& other) const { return position != other.position; }
+		bool operator<(const Iterator& other) const { return position < other.position; }
+		bool operator>(const Iterator& other) const { return position > other.position; }
+		bool operator<=(const Iterator& other) const { return position <= other.position; }
+		bool operator>=(const Iterator& other) const { return position >= other.position; }
+
+	private:
+		Ty* position;
+		size_t stride;
+	};
+
+	StridedView() :
+		first(nullptr),
+		count(0),
+		stride(1)
+	{}
+
+	StridedView(Ty* first, const size_t count, const size_t stride = 1) :
+		first(first),
+		count(count),
+		stride(stride)
+	{}
+
+	Ty& operator[](const size_t index) const
+	{
+		return first[index * stride];
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	Ty* data() const
+	{
+		return first;
+	}
+
+	size_t GetStride() const
+	{
+		return stride;
+	}
+
+	bool IsContiguous() const
+	{
+		return stride == 1;
+	}
+
+	Iterator begin() const
+	{
+		return Iterator(first, stride);
+	}
+
+	Iterator end() const
+	{
+		return Iterator(first + count * stride, stride);
+	}
+
+	// the explicit copy for callers that need to own the values
+	std::vector<value_type> ToVector() const
+	{
+		return std::vector<value_type>(begin(), end());
+	}
+
+private:
+	Ty* first;
+	size_t count;
+	size_t stride;
+};
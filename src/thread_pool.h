@@ -0,0 +1,287 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+
+// Persistent worker threads, one per hardware thread besides the caller.
+// ParallelFor hands out contiguous blocks of task indexes to the worker queues,
+// a worker takes tasks from the front of its own queue
+// and steals from the back of the others when it runs dry.
+// The calling thread works on the tasks too until all are finished,
+// so small calls need no worker and nested calls cannot deadlock.
+class ThreadPool
+{
+public:
+
+	// number_workers 0 selects hardware threads - 1
+	explicit ThreadPool(size_t number_workers = 0) :
+		queued_tasks(0),
+		stop(false)
+	{
+		if (number_workers == 0)
+		{
+			const size_t hardware_threads = std::thread::hardware_concurrency();
+			number_workers = hardware_threads > 1 ? hardware_threads - 1 : 0;
+		}
+
+		// the last queue takes tasks if there are no workers
+		queues.reserve(number_workers + 1);
+		for (size_t index = 0; index < number_workers + 1; ++index)
+		{
+			queues.push_back(std::make_unique<TaskQueue>());
+		}
+
+		workers.reserve(number_workers);
+		for (size_t index = 0; index < number_workers; ++index)
+		{
+			workers.emplace_back(&ThreadPool::Work, this, index);
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stop = true;
+		}
+		work_available.notify_all();
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// workers and the calling thread
+	size_t GetNumberThreads() const
+	{
+		return workers.size() + 1;
+	}
+
+	// calls function(task_index) for every index in [0, number_tasks) and returns when all are done,
+	// the first exception thrown by a task is rethrown here
+	template<typename FunctionTy>
+	void ParallelFor(const size_t number_tasks, FunctionTy function)
+	{
+		if (number_tasks == 0)
+		{
+			return;
+		}
+
+		if (number_tasks == 1 || workers.empty())
+		{
+			for (size_t task_index = 0; task_index < number_tasks; ++task_index)
+			{
+				function(task_index);
+			}
+			return;
+		}
+
+		Job job(function, number_tasks);
+		Submit(job);
+
+		Task task;
+		while (job.remaining.load(std::memory_order_acquire) > 0 && TryTake(queues.size() - 1, task))
+		{
+			Run(task);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(job.mutex);
+			job.finished.wait(lock, [&job]()
+				{
+					return job.remaining.load(std::memory_order_acquire) == 0;
+				});
+		}
+
+		if (job.exception)
+		{
+			std::rethrow_exception(job.exception);
+		}
+	}
+
+private:
+
+	struct Job
+	{
+		template<typename FunctionTy>
+		Job(FunctionTy& function, const size_t number_tasks) :
+			function(std::ref(function)),
+			remaining(number_tasks)
+		{}
+
+		std::function<void(size_t)> function;
+		std::atomic<size_t> remaining;
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::exception_ptr exception;
+	};
+
+	struct Task
+	{
+		Job* job = nullptr;
+		size_t index = 0;
+	};
+
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	// queue i gets the i-th block of task indexes,
+	// the tasks are counted before they can be taken, so the count never drops below zero
+	void Submit(Job& job)
+	{
+		const size_t number_tasks = job.remaining.load(std::memory_order_relaxed);
+		const size_t number_queues = std::min(queues.size(), number_tasks);
+
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			queued_tasks += number_tasks;
+		}
+
+		for (size_t queue_index = 0; queue_index < number_queues; ++queue_index)
+		{
+			const size_t begin = number_tasks * queue_index / number_queues;
+			const size_t end = number_tasks * (queue_index + 1) / number_queues;
+
+			std::lock_guard<std::mutex> lock(queues[queue_index]->mutex);
+			for (size_t task_index = begin; task_index < end; ++task_index)
+			{
+				queues[queue_index]->tasks.push_back({ &job, task_index });
+			}
+		}
+
+		work_available.notify_all();
+	}
+
+	// own queue first, then steal from the others
+	bool TryTake(const size_t queue_index, Task& task)
+	{
+		for (size_t offset = 0; offset < queues.size(); ++offset)
+		{
+			TaskQueue& queue = *queues[(queue_index + offset) % queues.size()];
+
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				if (offset == 0)
+				{
+					task = queue.tasks.front();
+					queue.tasks.pop_front();
+				}
+				else
+				{
+					task = queue.tasks.back();
+					queue.tasks.pop_back();
+				}
+
+				queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Run(const Task& task)
+	{
+		Job& job = *task.job;
+
+		try
+		{
+			job.function(task.index);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(job.mutex);
+			if (!job.exception)
+			{
+				job.exception = std::current_exception();
+			}
+		}
+
+		// the caller may return as soon as remaining is 0,
+		// the notification is sent under the lock of the job
+		std::lock_guard<std::mutex> lock(job.mutex);
+		if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			job.finished.notify_all();
+		}
+	}
+
+	void Work(const size_t queue_index)
+	{
+		Task task;
+
+		while (true)
+		{
+			if (TryTake(queue_index, task))
+			{
+				Run(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			work_available.wait(lock, [this]()
+				{
+					return stop || queued_tasks.load(std::memory_order_relaxed) > 0;
+				});
+
+			if (stop)
+			{
+				return;
+			}
+		}
+	}
+
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::atomic<size_t> queued_tasks;
+	bool stop;
+	std::mutex sleep_mutex;
+	std::condition_variable work_available;
+};
+
+
+// started on first use, stopped at program exit
+inline ThreadPool& GetThreadPool()
+{
+	static ThreadPool thread_pool;
+	return thread_pool;
+}
@@ -0,0 +1,322 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "cpu_dispatch.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
+#include <limits>
+#include <type_traits>
+#include <immintrin.h>
+
+
+// Uniform floating point numbers from raw engine bits:
+// the upper bits become the mantissa of a number in [1, 2),
+// subtracting 1 gives [0, 1) and subtracting 1 - 2^-(digits + 1) gives (0, 1)
+
+enum UniformInterval
+{
+	closed_open,
+	open_open
+};
+
+constexpr size_t uniform_batch_size = 256;
+
+
+template<typename EngineTy>
+void FillRandomBits(EngineTy& engine, std::uint32_t* bits, const size_t count)
+{
+	using EngineResultTy = typename EngineTy::result_type;
+	static_assert((EngineTy::min)() == 0 && (EngineTy::max)() == std::numeric_limits<EngineResultTy>::max(), "engine has to deliver full range words");
+	static_assert(sizeof(EngineResultTy) == 4 || sizeof(EngineResultTy) == 8, "engine has to deliver 32 or 64 bit words");
+
+	if constexpr (sizeof(EngineResultTy) == 4)
+	{
+		for (size_t index = 0; index < count; ++index)
+		{
+			bits[index] = static_cast<std::uint32_t>(engine());
+		}
+	}
+	else
+	{
+		size_t index = 0;
+		for (; index + 1 < count; index += 2)
+		{
+			const std::uint64_t word = engine();
+			bits[index] = static_cast<std::uint32_t>(word);
+			bits[index + 1] = static_cast<std::uint32_t>(word >> 32);
+		}
+		if (index < count)
+		{
+			bits[index] = static_cast<std::uint32_t>(engine());
+		}
+	}
+}
+
+template<typename EngineTy>
+void FillRandomBits(EngineTy& engine, std::uint64_t* bits, const size_t count)
+{
+	using EngineResultTy = typename EngineTy::result_type;
+
+	if constexpr (sizeof(EngineResultTy) == 4)
+	{
+		for (size_t index = 0; index < count; ++index)
+		{
+			const std::uint64_t low = static_cast<std::uint32_t>(engine());
+			const std::uint64_t high = static_cast<std::uint32_t>(engine());
+			bits[index] = (high << 32) | low;
+		}
+	}
+	else
+	{
+		static_assert((EngineTy::min)() == 0 && (EngineTy::max)() == std::numeric_limits<EngineResultTy>::max(), "engine has to deliver full range words");
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			bits[index] = static_cast<std::uint64_t>(engine());
+		}
+	}
+}
+
+
+// one word of bits to a uniform number, the scalar conversion of BitsToUniform
+inline float UniformFromBits(const std::uint32_t bits, const UniformInterval interval = closed_open)
+{
+	const float subtrahend = interval == closed_open ? 1.0f : 1.0f - 0x1.0p-24f;
+	const std::uint32_t pattern = (bits >> 9) | 0x3F800000u;
+	float value;
+	std::memcpy(&value, &pattern, sizeof(value));
+	return value - subtrahend;
+}
+
+inline double UniformFromBits(const std::uint64_t bits, const UniformInterval interval = closed_open)
+{
+	const double subtrahend = interval == closed_open ? 1.0 : 1.0 - 0x1.0p-53;
+	const std::uint64_t pattern = (bits >> 12) | 0x3FF0000000000000ull;
+	double value;
+	std::memcpy(&value, &pattern, sizeof(value));
+	return value - subtrahend;
+}
+
+
+// vector kernels convert whole vectors from index on
+// and return the index of the first unconverted value
+
+SIMD_TARGET("avx512f")
+inline size_t BitsToUniformAvx512(const std::uint32_t* bits, float* values, size_t index, const size_t count, const float subtrahend)
+{
+	const __m512i exponent_one_16 = _mm512_set1_epi32(0x3F800000);
+	const __m512 subtrahend_16 = _mm512_set1_ps(subtrahend);
+	for (; index + 16 <= count; index += 16)
+	{
+		const __m512i mantissa = _mm512_srli_epi32(_mm512_loadu_si512(bits + index), 9);
+		_mm512_storeu_ps(values + index, _mm512_sub_ps(_mm512_castsi512_ps(_mm512_or_si512(mantissa, exponent_one_16)), subtrahend_16));
+	}
+	return index;
+}
+
+SIMD_TARGET("avx2")
+inline size_t BitsToUniformAvx2(const std::uint32_t* bits, float* values, size_t index, const size_t count, const float subtrahend)
+{
+	const __m256i exponent_one_8 = _mm256_set1_epi32(0x3F800000);
+	const __m256 subtrahend_8 = _mm256_set1_ps(subtrahend);
+	for (; index + 8 <= count; index += 8)
+	{
+		const __m256i mantissa = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + index)), 9);
+		_mm256_storeu_ps(values + index, _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(mantissa, exponent_one_8)), subtrahend_8));
+	}
+	return index;
+}
+
+SIMD_TARGET("sse2")
+inline size_t BitsToUniformSse2(const std::uint32_t* bits, float* values, size_t index, const size_t count, const float subtrahend)
+{
+	const __m128i exponent_one_4 = _mm_set1_epi32(0x3F800000);
+	const __m128 subtrahend_4 = _mm_set1_ps(subtrahend);
+	for (; index + 4 <= count; index += 4)
+	{
+		const __m128i mantissa = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + index)), 9);
+		_mm_storeu_ps(values + index, _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(mantissa, exponent_one_4)), subtrahend_4));
+	}
+	return index;
+}
+
+SIMD_TARGET("avx512f")
+inline size_t BitsToUniformAvx512(const std::uint64_t* bits, double* values, size_t index, const size_t count, const double subtrahend)
+{
+	const __m512i exponent_one_8 = _mm512_set1_epi64(0x3FF0000000000000ll);
+	const __m512d subtrahend_8 = _mm512_set1_pd(subtrahend);
+	for (; index + 8 <= count; index += 8)
+	{
+		const __m512i mantissa = _mm512_srli_epi64(_mm512_loadu_si512(bits + index), 12);
+		_mm512_storeu_pd(values + index, _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(mantissa, exponent_one_8)), subtrahend_8));
+	}
+	return index;
+}
+
+SIMD_TARGET("avx2")
+inline size_t BitsToUniformAvx2(const std::uint64_t* bits, double* values, size_t index, const size_t count, const double subtrahend)
+{
+	const __m256i exponent_one_4 = _mm256_set1_epi64x(0x3FF0000000000000ll);
+	const __m256d subtrahend_4 = _mm256_set1_pd(subtrahend);
+	for (; index + 4 <= count; index += 4)
+	{
+		const __m256i mantissa = _mm256_srli_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + index)), 12);
+		_mm256_storeu_pd(values + index, _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(mantissa, exponent_one_4)), subtrahend_4));
+	}
+	return index;
+}
+
+SIMD_TARGET("sse2")
+inline size_t BitsToUniformSse2(const std::uint64_t* bits, double* values, size_t index, const size_t count, const double subtrahend)
+{
+	const __m128i exponent_one_2 = _mm_set1_epi64x(0x3FF0000000000000ll);
+	const __m128d subtrahend_2 = _mm_set1_pd(subtrahend);
+	for (; index + 2 <= count; index += 2)
+	{
+		const __m128i mantissa = _mm_srli_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + index)), 12);
+		_mm_storeu_pd(values + index, _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(mantissa, exponent_one_2)), subtrahend_2));
+	}
+	return index;
+}
+
+
+inline void BitsToUniform(const std::uint32_t* bits, float* values, const size_t count, const UniformInterval interval = closed_open)
+{
+	const float subtrahend = interval == closed_open ? 1.0f : 1.0f - 0x1.0p-24f;
+	const SimdLevels simd_level = GetSimdLevel();
+
+	size_t index = 0;
+
+	if (simd_level == simd_avx512)
+	{
+		index = BitsToUniformAvx512(bits, values, index, count, subtrahend);
+	}
+	if (simd_level >= simd_avx2)
+	{
+		index = BitsToUniformAvx2(bits, values, index, count, subtrahend);
+	}
+	index = BitsToUniformSse2(bits, values, index, count, subtrahend);
+
+	for (; index < count; ++index)
+	{
+		values[index] = UniformFromBits(bits[index], interval);
+	}
+}
+
+inline void BitsToUniform(const std::uint64_t* bits, double* values, const size_t count, const UniformInterval interval = closed_open)
+{
+	const double subtrahend = interval == closed_open ? 1.0 : 1.0 - 0x1.0p-53;
+	const SimdLevels simd_level = GetSimdLevel();
+
+	size_t index = 0;
+
+	if (simd_level == simd_avx512)
+	{
+		index = BitsToUniformAvx512(bits, values, index, count, subtrahend);
+	}
+	if (simd_level >= simd_avx2)
+	{
+		index = BitsToUniformAvx2(bits, values, index, count, subtrahend);
+	}
+	index = BitsToUniformSse2(bits, values, index, count, subtrahend);
+
+	for (; index < count; ++index)
+	{
+		values[index] = UniformFromBits(bits[index], interval);
+	}
+}
+
+
+// fills values with uniform numbers in [0, 1) or (0, 1),
+// bits are drawn in blocks of uniform_batch_size words
+template<typename EngineTy, typename RealTy>
+void FillUniform(EngineTy& engine, RealTy* values, const size_t count, const UniformInterval interval = closed_open)
+{
+	static_assert(std::is_same<RealTy, float>::value || std::is_same<RealTy, double>::value, "uniform batch supports float and double");
+
+	using BitsTy = typename std::conditional<std::is_same<RealTy, float>::value, std::uint32_t, std::uint64_t>::type;
+
+	alignas(64) std::array<BitsTy, uniform_batch_size> bits;
+
+	for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+	{
+		const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+
+		FillRandomBits(engine, bits.data(), batch_count);
+		BitsToUniform(bits.data(), values + offset, batch_count, interval);
+	}
+}
+
+
+// a single uniform number in [0, 1) or (0, 1), the same as FillUniform with count 1,
+// for callers drawing one value at a time without the vector kernels
+template<typename RealTy, typename EngineTy>
+RealTy SampleUniform(EngineTy& engine, const UniformInterval interval = closed_open)
+{
+	static_assert(std::is_same<RealTy, float>::value || std::is_same<RealTy, double>::value, "uniform batch supports float and double");
+
+	using BitsTy = typename std::conditional<std::is_same<RealTy, float>::value, std::uint32_t, std::uint64_t>::type;
+
+	BitsTy bits;
+	FillRandomBits(engine, &bits, 1);
+	return UniformFromBits(bits, interval);
+}
+
+
+// serves single uniform numbers from a batch,
+// for rejection samplers with a variable number of draws per value
+template<typename RealTy>
+class UniformBuffer
+{
+public:
+
+	UniformBuffer(const UniformInterval interval = closed_open) :
+		interval(interval),
+		position(uniform_batch_size)
+	{}
+
+	template<typename EngineTy>
+	RealTy Next(EngineTy& engine)
+	{
+		if (position == uniform_batch_size)
+		{
+			FillUniform(engine, values.data(), values.size(), interval);
+			position = 0;
+		}
+		return values[position++];
+	}
+
+	// drops buffered numbers, for counter based engines restarting a stream
+	void Reset()
+	{
+		position = uniform_batch_size;
+	}
+
+private:
+	UniformInterval interval;
+	alignas(64) std::array<RealTy, uniform_batch_size> values;
+	size_t position;
+};
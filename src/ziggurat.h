@@ -0,0 +1,308 @@
+/*
+random_samples
+Copyright(c) 2020 Marco Peyer
+
+This program is free software; you can redistribute itand /or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+
+See <https://www.gnu.org/licenses/gpl-2.0.txt>.
+*/
+
+#pragma once
+
+#include "cpu_dispatch.h"
+#include "uniform_batch.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <immintrin.h>
+
+
+// Marsaglia, Tsang, The Ziggurat Method for Generating Random Variables,
+// 128 layers of equal area for the standard normal density.
+// Layer index, sign and magnitude come from disjoint bits of one word,
+// about 99% of the words are accepted by a single compare.
+
+template<typename RealTy>
+struct ZigguratTraits;
+
+template<>
+struct ZigguratTraits<float>
+{
+	using BitsTy = std::uint32_t;
+	using ThresholdTy = std::int32_t;
+	static constexpr int magnitude_bits = 24;
+};
+
+template<>
+struct ZigguratTraits<double>
+{
+	using BitsTy = std::uint64_t;
+	using ThresholdTy = std::int64_t;
+	static constexpr int magnitude_bits = 53;
+};
+
+
+template<typename RealTy>
+class ZigguratNormal
+{
+public:
+
+	using BitsTy = typename ZigguratTraits<RealTy>::BitsTy;
+	using ThresholdTy = typename ZigguratTraits<RealTy>::ThresholdTy;
+
+	static constexpr size_t number_layers = 128;
+	static constexpr int magnitude_shift = static_cast<int>(sizeof(BitsTy) * 8) - ZigguratTraits<RealTy>::magnitude_bits;
+
+	template<typename EngineTy>
+	RealTy Sample(EngineTy& engine) const
+	{
+		BitsTy bits;
+		FillRandomBits(engine, &bits, 1);
+		return SampleFromBits(engine, bits);
+	}
+
+	// standard normal values
+	template<typename EngineTy>
+	void Fill(EngineTy& engine, RealTy* values, const size_t count) const
+	{
+		alignas(64) std::array<BitsTy, uniform_batch_size> bits;
+
+		for (size_t offset = 0; offset < count; offset += uniform_batch_size)
+		{
+			const size_t batch_count = count - offset < uniform_batch_size ? count - offset : uniform_batch_size;
+
+			FillRandomBits(engine, bits.data(), batch_count);
+			FillFromBits(engine, bits.data(), values + offset, batch_count);
+		}
+	}
+
+private:
+
+	struct Tables
+	{
+		std::array<double, number_layers + 1> x;
+		std::array<double, number_layers + 1> f;
+		std::array<ThresholdTy, number_layers> threshold;
+		std::array<RealTy, number_layers> width;
+	};
+
+	static constexpr double tail_start = 3.442619855899;
+	static constexpr double layer_area = 9.91256303526217e-3;
+
+	static const Tables& GetTables()
+	{
+		static const Tables tables = CreateTables();
+		return tables;
+	}
+
+	static Tables CreateTables()
+	{
+		Tables tables;
+
+		const double magnitude_scale = std::ldexp(1.0, ZigguratTraits<RealTy>::magnitude_bits);
+
+		// x[0] is the width of a rectangle with the area of base strip and tail
+		tables.x[0] = layer_area / std::exp(-0.5 * tail_start * tail_start);
+		tables.x[1] = tail_start;
+		for (size_t index = 1; index < number_layers - 1; ++index)
+		{
+			tables.x[index + 1] = std::sqrt(-2.0 * std::log(layer_area / tables.x[index] + std::exp(-0.5 * tables.x[index] * tables.x[index])));
+		}
+		tables.x[number_layers] = 0.0;
+
+		for (size_t index = 0; index <= number_layers; ++index)
+		{
+			tables.f[index] = std::exp(-0.5 * tables.x[index] * tables.x[index]);
+		}
+
+		for (size_t index = 0; index < number_layers; ++index)
+		{
+			tables.threshold[index] = static_cast<ThresholdTy>(std::floor(tables.x[index + 1] / tables.x[index] * magnitude_scale));
+			tables.width[index] = static_cast<RealTy>(tables.x[index] / magnitude_scale);
+		}
+
+		return tables;
+	}
+
+	// the fast path writes all values and collects the rejected lanes,
+	// these are completed in index order afterwards,
+	// so every instruction set produces the same numbers
+	template<typename EngineTy>
+	void FillFromBits(EngineTy& engine, const BitsTy* bits, RealTy* values, const size_t count) const
+	{
+		std::array<std::uint16_t, uniform_batch_size> rejected;
+		size_t number_rejected = 0;
+		size_t index = 0;
+
+		if constexpr (std::is_same<RealTy, float>::value)
+		{
+			const SimdLevels simd_level = GetSimdLevel();
+
+			if (simd_level == simd_avx512)
+			{
+				index = FillFromBitsAvx512(bits, values, index, count, rejected.data(), number_rejected);
+			}
+			if (simd_level >= simd_avx2)
+			{
+				index = FillFromBitsAvx2(bits, values, index, count, rejected.data(), number_rejected);
+			}
+		}
+
+		const Tables& tables = GetTables();
+
+		for (; index < count; ++index)
+		{
+			const size_t layer = static_cast<size_t>(bits[index] & (number_layers - 1));
+			const ThresholdTy magnitude = static_cast<ThresholdTy>(bits[index] >> magnitude_shift);
+			const RealTy value = static_cast<RealTy>(magnitude) * tables.width[layer];
+
+			values[index] = (bits[index] & number_layers) != 0 ? -value : value;
+
+			if (!(magnitude < tables.threshold[layer]))
+			{
+				rejected[number_rejected++] = static_cast<std::uint16_t>(index);
+			}
+		}
+
+		for (size_t position = 0; position < number_rejected; ++position)
+		{
+			values[rejected[position]] = SampleFromBits(engine, bits[rejected[position]]);
+		}
+	}
+
+	SIMD_TARGET("avx512f")
+	static size_t FillFromBitsAvx512(const BitsTy* bits, RealTy* values, size_t index, const size_t count, std::uint16_t* rejected, size_t& number_rejected)
+	{
+		const Tables& tables = GetTables();
+
+		const __m512i index_mask_16 = _mm512_set1_epi32(number_layers - 1);
+		const __m512i sign_mask_16 = _mm512_set1_epi32(number_layers);
+		for (; index + 16 <= count; index += 16)
+		{
+			const __m512i word = _mm512_loadu_si512(bits + index);
+			const __m512i layer = _mm512_and_si512(word, index_mask_16);
+			const __m512i magnitude = _mm512_srli_epi32(word, magnitude_shift);
+			const __m512i threshold = _mm512_i32gather_epi32(layer, tables.threshold.data(), 4);
+			const __m512 width = _mm512_i32gather_ps(layer, tables.width.data(), 4);
+			const __m512i sign = _mm512_slli_epi32(_mm512_and_si512(word, sign_mask_16), 24);
+
+			const __m512 value = _mm512_mul_ps(_mm512_cvtepi32_ps(magnitude), width);
+			_mm512_storeu_ps(values + index, _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(value), sign)));
+
+			const __mmask16 accepted = _mm512_cmplt_epi32_mask(magnitude, threshold);
+			if (accepted != 0xFFFF)
+			{
+				for (size_t lane = 0; lane < 16; ++lane)
+				{
+					if (!(accepted & (1u << lane)))
+					{
+						rejected[number_rejected++] = static_cast<std::uint16_t>(index + lane);
+					}
+				}
+			}
+		}
+		return index;
+	}
+
+	SIMD_TARGET("avx2")
+	static size_t FillFromBitsAvx2(const BitsTy* bits, RealTy* values, size_t index, const size_t count, std::uint16_t* rejected, size_t& number_rejected)
+	{
+		const Tables& tables = GetTables();
+
+		const __m256i index_mask_8 = _mm256_set1_epi32(number_layers - 1);
+		const __m256i sign_mask_8 = _mm256_set1_epi32(number_layers);
+		for (; index + 8 <= count; index += 8)
+		{
+			const __m256i word = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + index));
+			const __m256i layer = _mm256_and_si256(word, index_mask_8);
+			const __m256i magnitude = _mm256_srli_epi32(word, magnitude_shift);
+			const __m256i threshold = _mm256_i32gather_epi32(tables.threshold.data(), layer, 4);
+			const __m256 width = _mm256_i32gather_ps(tables.width.data(), layer, 4);
+			const __m256i sign = _mm256_slli_epi32(_mm256_and_si256(word, sign_mask_8), 24);
+
+			const __m256 value = _mm256_mul_ps(_mm256_cvtepi32_ps(magnitude), width);
+			_mm256_storeu_ps(values + index, _mm256_castsi256_ps(_mm256_xor_si256(_mm256_castps_si256(value), sign)));
+
+			const int accepted = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(threshold, magnitude)));
+			if (accepted != 0xFF)
+			{
+				for (size_t lane = 0; lane < 8; ++lane)
+				{
+					if (!(accepted & (1 << lane)))
+					{
+						rejected[number_rejected++] = static_cast<std::uint16_t>(index + lane);
+					}
+				}
+			}
+		}
+		return index;
+	}
+
+	template<typename EngineTy>
+	RealTy SampleFromBits(EngineTy& engine, BitsTy bits) const
+	{
+		const Tables& tables = GetTables();
+
+		for (;;)
+		{
+			const size_t layer = static_cast<size_t>(bits & (number_layers - 1));
+			const bool negative = (bits & number_layers) != 0;
+			const ThresholdTy magnitude = static_cast<ThresholdTy>(bits >> magnitude_shift);
+			const RealTy value = static_cast<RealTy>(magnitude) * tables.width[layer];
+
+			if (magnitude < tables.threshold[layer])
+			{
+				return negative ? -value : value;
+			}
+
+			if (layer == 0)
+			{
+				const RealTy tail = static_cast<RealTy>(tail_start + SampleTail(engine));
+				return negative ? -tail : tail;
+			}
+
+			const RealTy uniform = SampleUniform<RealTy>(engine);
+
+			const double wedge = tables.f[layer] + static_cast<double>(uniform) * (tables.f[layer + 1] - tables.f[layer]);
+			if (wedge < std::exp(-0.5 * static_cast<double>(value) * static_cast<double>(value)))
+			{
+				return negative ? -value : value;
+			}
+
+			FillRandomBits(engine, &bits, 1);
+		}
+	}
+
+	// Marsaglia, tail beyond tail_start
+	template<typename EngineTy>
+	double SampleTail(EngineTy& engine) const
+	{
+		double tail;
+		double height;
+		do
+		{
+			std::array<double, 2> uniform;
+			FillUniform(engine, uniform.data(), uniform.size(), open_open);
+
+			tail = -std::log(uniform[0]) / tail_start;
+			height = -std::log(uniform[1]);
+		} while (height + height < tail * tail);
+
+		return tail;
+	}
+};